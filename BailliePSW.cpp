@@ -0,0 +1,341 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "BailliePSW.h"
+
+
+
+Int32 BailliePSW::jacobiSmall( Int64 a, Int64 n )
+{
+if( (n <= 0) || ((n & 1) == 0) )
+  throw "BailliePSW.jacobiSmall() bad n.";
+
+a = a % n;
+if( a < 0 )
+  a += n;
+
+Int32 result = 1;
+while( a != 0 )
+  {
+  while( (a & 1) == 0 )
+    {
+    a >>= 1;
+    const Int64 nMod8 = n & 7;
+    if( (nMod8 == 3) || (nMod8 == 5) )
+      result = -result;
+
+    }
+
+  // Quadratic reciprocity.
+  Int64 swap = a;
+  a = n;
+  n = swap;
+  if( ((a & 3) == 3) && ((n & 3) == 3) )
+    result = -result;
+
+  a = a % n;
+  }
+
+if( n == 1 )
+  return result;
+
+return 0;
+}
+
+
+
+// a has to fit in 24 bits, which it always
+// does for the D values here.
+
+Int32 BailliePSW::jacobi( const Int64 a,
+                          const Integer& n,
+                          IntegerMath& intMath )
+{
+if( n.getNegative() || ((n.getD( 0 ) & 1) == 0) )
+  throw "BailliePSW.jacobi() bad n.";
+
+if( n.getIndex() == 0 )
+  return jacobiSmall( a, n.getD( 0 ));
+
+if( a == 0 )
+  return 0;
+
+const Int64 nMod8 = n.getD( 0 ) & 7;
+Int32 result = 1;
+Int64 absA = a;
+if( absA < 0 )
+  {
+  absA = -absA;
+
+  // (-1/n)
+  if( (nMod8 & 3) == 3 )
+    result = -result;
+
+  }
+
+if( (absA >> 24) != 0 )
+  throw "BailliePSW.jacobi() a is too big.";
+
+while( (absA & 1) == 0 )
+  {
+  absA >>= 1;
+
+  // (2/n)
+  if( (nMod8 == 3) || (nMod8 == 5) )
+    result = -result;
+
+  }
+
+if( absA == 1 )
+  return result;
+
+// Quadratic reciprocity turns it in to
+// (n/a), and n mod a is a small number.
+if( ((absA & 3) == 3) && ((nMod8 & 3) == 3) )
+  result = -result;
+
+const Int64 nModA = intMath.getMod24( n, absA );
+return result * jacobiSmall( nModA, absA );
+}
+
+
+
+void BailliePSW::halveMod( Integer& toHalve,
+                           const Integer& n,
+                           IntegerMath& intMath )
+{
+// It is less than n, so adding n to an odd
+// number makes an even number less than 2n.
+if( (toHalve.getD( 0 ) & 1) != 0 )
+  intMath.add( toHalve, n );
+
+toHalve.shiftRight( 1 );
+}
+
+
+
+void BailliePSW::setSigned( Integer& result,
+                            const Int64 value,
+                            const Integer& n,
+                            IntegerMath& intMath )
+{
+Int64 absValue = value;
+if( absValue < 0 )
+  absValue = -absValue;
+
+result.setFromLong48( absValue );
+if( n.paramIsGreaterOrEq( result ))
+  millerRabin.getMod().makeExact( result, n,
+                                  intMath );
+
+if( (value < 0) && !result.isZero())
+  millerRabin.getMod().negate( result, n,
+                               intMath );
+
+}
+
+
+
+// Selfridge's method A.  The first D in
+// 5, -7, 9, -11, 13, ... with (D/n) = -1.
+// This returns zero if it finds that n is
+// composite.
+
+Int64 BailliePSW::findD( const Integer& n,
+                         IntegerMath& intMath )
+{
+Int64 D = 5;
+for( Int32 count = 0; count < 10000; count++ )
+  {
+  const Int32 j = jacobi( D, n, intMath );
+  if( j == -1 )
+    return D;
+
+  if( j == 0 )
+    {
+    // D and n have a factor in common.
+    // If n is not D itself it's composite.
+    Int64 absD = D;
+    if( absD < 0 )
+      absD = -absD;
+
+    if( !n.isEqualToInt48( absD ))
+      return 0;
+
+    }
+
+  // If n is a perfect square there is no D
+  // that works.  This doesn't happen often,
+  // so it is only checked after a few tries.
+  if( count == 10 )
+    {
+    if( intMath.squareRoot( n, temp ))
+      return 0;
+
+    }
+
+  if( D > 0 )
+    D = -(D + 2);
+  else
+    D = -D + 2;
+
+  }
+
+throw "BailliePSW.findD() didn't find D.";
+}
+
+
+
+bool BailliePSW::isStrongLucasProbable(
+                          const Integer& n,
+                          const Int64 D,
+                          IntegerMath& intMath )
+{
+Mod& mod = millerRabin.getMod();
+
+// P is 1 and Q = (1 - D) / 4.
+setSigned( QMod, (1 - D) / 4, n, intMath );
+
+// n + 1 = oddPart * 2^twoPower.
+nPlus1.copy( n );
+nPlus1.increment();
+oddPart.copy( nPlus1 );
+Int32 twoPower = 0;
+while( (oddPart.getD( 0 ) & 1) == 0 )
+  {
+  oddPart.shiftRight( 1 );
+  twoPower++;
+  }
+
+// Start with U_1 = 1, V_1 = P = 1 and Q^1
+// for the top bit, then go down through the
+// rest of the bits, doubling, and then
+// adding one if the bit is set.
+U.setToOne();
+V.setToOne();
+Qk.copy( QMod );
+
+const Int32 topDigit = oddPart.getIndex();
+Int32 topBit = 23;
+while( ((oddPart.getD( topDigit ) >> topBit)
+                                     & 1) == 0 )
+  topBit--;
+
+Int64 absD = D;
+if( absD < 0 )
+  absD = -absD;
+
+for( Int32 digit = topDigit; digit >= 0;
+                                      digit-- )
+  {
+  Int32 bit = 23;
+  if( digit == topDigit )
+    bit = topBit - 1;
+
+  const Int64 dValue = oddPart.getD( digit );
+  for( ; bit >= 0; bit-- )
+    {
+    // U_2k = U_k * V_k
+    mod.multiply( U, V, n, intMath );
+
+    // V_2k = V_k^2 - 2Q^k
+    temp.copy( V );
+    mod.multiply( V, temp, n, intMath );
+    temp.copy( Qk );
+    mod.add( temp, Qk, n, intMath );
+    mod.subtract( V, temp, n, intMath );
+
+    // Q^2k
+    temp.copy( Qk );
+    mod.multiply( Qk, temp, n, intMath );
+
+    if( ((dValue >> bit) & 1) == 0 )
+      continue;
+
+    // U_k+1 = (P * U_k + V_k) / 2
+    // V_k+1 = (D * U_k + P * V_k) / 2
+    temp.copy( U );
+    mod.add( temp, V, n, intMath );
+    halveMod( temp, n, intMath );
+
+    temp2.copy( U );
+    mod.multiplyL( temp2, absD, n, intMath );
+    if( (D < 0) && !temp2.isZero())
+      mod.negate( temp2, n, intMath );
+
+    mod.add( temp2, V, n, intMath );
+    halveMod( temp2, n, intMath );
+
+    U.copy( temp );
+    V.copy( temp2 );
+
+    mod.multiply( Qk, QMod, n, intMath );
+    }
+  }
+
+if( U.isZero() || V.isZero())
+  return true;
+
+// V_(d * 2^r) for r up to twoPower - 1.
+for( Int32 count = 1; count < twoPower;
+                                      count++ )
+  {
+  temp.copy( V );
+  mod.multiply( V, temp, n, intMath );
+  temp.copy( Qk );
+  mod.add( temp, Qk, n, intMath );
+  mod.subtract( V, temp, n, intMath );
+  if( V.isZero())
+    return true;
+
+  temp.copy( Qk );
+  mod.multiply( Qk, temp, n, intMath );
+  }
+
+return false;
+}
+
+
+
+bool BailliePSW::isProbablePrime(
+                     const Integer& n,
+                     const SPrimes& sPrimes,
+                     IntegerMath& intMath )
+{
+if( n.getNegative() )
+  return false;
+
+if( n.getIndex() == 0 )
+  {
+  if( n.getD( 0 ) < 2 )
+    return false;
+
+  if( n.getD( 0 ) <= 3 )
+    return true;
+
+  }
+
+Int32 smallPrime = intMath.isDivisibleBySmallPrime(
+                                   n, sPrimes );
+if( smallPrime != 0 )
+  return n.isEqualToInt24( smallPrime );
+
+Integer two;
+two.setFromLong48( 2 );
+if( !millerRabin.testBase( n, two, intMath ))
+  return false;
+
+const Int64 D = findD( n, intMath );
+if( D == 0 )
+  return false;
+
+return isStrongLucasProbable( n, D, intMath );
+}
@@ -0,0 +1,105 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// The Baillie-PSW probable prime test.
+// It is one strong probable prime test to
+// base 2, then a strong Lucas probable prime
+// test with D, P and Q picked by Selfridge's
+// method A.  There are no known composite
+// numbers that pass both.
+
+// Robert Baillie and Samuel Wagstaff,
+// "Lucas Pseudoprimes", Mathematics of
+// Computation 35 (1980).
+
+// The Lucas part uses the same Mod that the
+// base 2 test used, so the NumbSys tables for
+// the candidate are only made once.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "Mod.h"
+#include "MillerRabin.h"
+#include "../CryptoBase/SPrimes.h"
+
+
+
+class BailliePSW
+  {
+  private:
+  bool testForCopy = false;
+  MillerRabin millerRabin;
+  Integer nPlus1;
+  Integer oddPart;
+  Integer U;
+  Integer V;
+  Integer Qk;
+  Integer QMod;
+  Integer temp;
+  Integer temp2;
+
+  void halveMod( Integer& toHalve,
+                 const Integer& n,
+                 IntegerMath& intMath );
+
+  void setSigned( Integer& result,
+                  const Int64 value,
+                  const Integer& n,
+                  IntegerMath& intMath );
+
+  Int64 findD( const Integer& n,
+               IntegerMath& intMath );
+
+  public:
+  BailliePSW( void )
+    {
+    }
+
+  BailliePSW( const BailliePSW& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "BailliePSW copy constructor.";
+    }
+
+  ~BailliePSW( void )
+    {
+    }
+
+  // The Jacobi symbol (a/n).  n is odd and
+  // positive.  a can be negative.
+  static Int32 jacobiSmall( Int64 a, Int64 n );
+  static Int32 jacobi( const Int64 a,
+                       const Integer& n,
+                       IntegerMath& intMath );
+
+  // n has to be odd and not a perfect square,
+  // and D has to have (D/n) = -1.
+  bool isStrongLucasProbable( const Integer& n,
+                              const Int64 D,
+                              IntegerMath& intMath );
+
+  bool isProbablePrime( const Integer& n,
+                        const SPrimes& sPrimes,
+                        IntegerMath& intMath );
+
+  inline MillerRabin& getMillerRabin( void )
+    {
+    return millerRabin;
+    }
+
+  };
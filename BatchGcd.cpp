@@ -0,0 +1,95 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "BatchGcd.h"
+#include "ProductTree.h"
+#include "LehmerGcd.h"
+#include "Division.h"
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+bool BatchGcd::getSharedFactor(
+                        const HeapInt& remainder,
+                        const Integer& modulus,
+                        Integer& factor,
+                        IntegerMath& intMath )
+{
+Integer rem;
+Integer others;
+remainder.copyToInteger( rem );
+
+// P is a multiple of N, so P mod N^2 is too.
+Division::divideExact( rem, modulus, others );
+if( others.isZero())
+  factor.copy( modulus );
+else
+  LehmerGcd::gcd( others, modulus, factor,
+                                   intMath );
+
+return !factor.isOne();
+}
+
+
+
+Int32 BatchGcd::findSharedFactors(
+                        const Integer* moduli,
+                        const Int32 howMany,
+                        Integer* factors,
+                        IntegerMath& intMath )
+{
+if( howMany < 1 )
+  return 0;
+
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  const Integer& modulus = moduli[count];
+  if( modulus.getNegative() || modulus.isZero())
+    throw "BatchGcd modulus is not positive.";
+
+  if( ((modulus.getIndex() + 1) * 2) >=
+                   IntConst::DigitArraySize )
+    throw "BatchGcd modulus is too big.";
+
+  }
+
+if( howMany == 1 )
+  {
+  factors[0].setToOne();
+  return 0;
+  }
+
+ProductTree tree;
+tree.build( moduli, howMany );
+
+HeapInt* remainders = new HeapInt[howMany];
+tree.remainderTree( tree.getTop(), true,
+                    remainders );
+
+Int32 found = 0;
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  if( getSharedFactor( remainders[count],
+                       moduli[count],
+                       factors[count], intMath ))
+    found++;
+
+  }
+
+delete[] remainders;
+return found;
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
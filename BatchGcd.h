@@ -0,0 +1,68 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// Batch gcd for finding RSA moduli that share
+// a prime.  With k moduli the gcd of every
+// pair is k^2 gcds.  This is Bernstein's way
+// of doing it.  P is the product of all of
+// them from a product tree.  The remainder
+// tree gets P mod N^2 for each N, and then
+// (P mod N^2) / N is the product of all of
+// the others mod N.  So the gcd of that with
+// N is the part of N that it shares with any
+// of the others.
+
+// See Nadia Heninger, Zakir Durumeric, Eric
+// Wustrow, J. Alex Halderman, "Mining Your
+// Ps and Qs: Detection of Widespread Weak Keys
+// in Network Devices", USENIX Security 2012.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "HeapInt.h"
+
+
+
+class BatchGcd
+  {
+  private:
+
+  public:
+  // remainder is P mod N^2 for a leaf.  This
+  // sets factor to what N shares with the
+  // others, and returns true if that isn't 1.
+  static bool getSharedFactor(
+                        const HeapInt& remainder,
+                        const Integer& modulus,
+                        Integer& factor,
+                        IntegerMath& intMath );
+
+  // Each factors[count] gets the gcd of
+  // moduli[count] with the product of all of
+  // the others.  That is 1 if it shares
+  // nothing.  If it is the whole modulus then
+  // both of its primes are shared, or the
+  // same modulus is in there twice, and a
+  // gcd with each of the others will sort
+  // it out.  It returns how many are not 1.
+  // N^2 has to fit in an Integer.
+  static Int32 findSharedFactors(
+                        const Integer* moduli,
+                        const Int32 howMany,
+                        Integer* factors,
+                        IntegerMath& intMath );
+
+  };
@@ -0,0 +1,518 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "DiskTree.h"
+#include "BatchGcd.h"
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+void TreeFile::writeInt32( const Int32 toWrite )
+{
+unsigned char bytes[4];
+bytes[0] = toWrite & 0xFF;
+bytes[1] = (toWrite >> 8) & 0xFF;
+bytes[2] = (toWrite >> 16) & 0xFF;
+bytes[3] = (toWrite >> 24) & 0xFF;
+if( fwrite( bytes, 1, 4, file ) != 4 )
+  throw "TreeFile.writeInt32() failed.";
+
+}
+
+
+
+Int32 TreeFile::readInt32( void )
+{
+unsigned char bytes[4];
+if( fread( bytes, 1, 4, file ) != 4 )
+  throw "TreeFile.readInt32() failed.";
+
+return static_cast<Int32>( bytes[0] ) |
+       (static_cast<Int32>( bytes[1] ) << 8) |
+       (static_cast<Int32>( bytes[2] ) << 16) |
+       (static_cast<Int32>( bytes[3] ) << 24);
+}
+
+
+
+void TreeFile::openWrite( const char* fileName,
+                          const Int32 setCount,
+                          const Int32 bufferSize )
+{
+close();
+file = fopen( fileName, "wb" );
+if( file == nullptr )
+  throw "TreeFile.openWrite() can't open file.";
+
+buffer = new char[bufferSize];
+setvbuf( file, buffer, _IOFBF, bufferSize );
+
+nodeCount = setCount;
+writeInt32( 0x314C5450 ); // PTL1
+writeInt32( nodeCount );
+}
+
+
+
+void TreeFile::openRead( const char* fileName,
+                         const Int32 bufferSize )
+{
+close();
+file = fopen( fileName, "rb" );
+if( file == nullptr )
+  throw "TreeFile.openRead() can't open file.";
+
+buffer = new char[bufferSize];
+setvbuf( file, buffer, _IOFBF, bufferSize );
+
+if( readInt32() != 0x314C5450 )
+  throw "TreeFile.openRead() not a tree file.";
+
+nodeCount = readInt32();
+}
+
+
+
+void TreeFile::close( void )
+{
+if( file != nullptr )
+  {
+  const bool closed = fclose( file ) == 0;
+  file = nullptr;
+  delete[] buffer;
+  buffer = nullptr;
+
+  if( !closed )
+    throw "TreeFile.close() failed.";
+
+  }
+}
+
+
+
+void TreeFile::writeNode( const HeapInt& node )
+{
+const Int32 size = node.getIndex() + 1;
+writeInt32( size );
+
+unsigned char bytes[3 * 1024];
+Int32 where = 0;
+while( where < size )
+  {
+  Int32 howMany = size - where;
+  if( howMany > 1024 )
+    howMany = 1024;
+
+  for( Int32 count = 0; count < howMany; count++ )
+    {
+    const Int64 digit = node.getD( where + count );
+    bytes[count * 3] = digit & 0xFF;
+    bytes[(count * 3) + 1] = (digit >> 8) & 0xFF;
+    bytes[(count * 3) + 2] = (digit >> 16) & 0xFF;
+    }
+
+  const size_t toWrite = static_cast<size_t>(
+                                  howMany * 3 );
+  if( fwrite( bytes, 1, toWrite, file ) !=
+                                      toWrite )
+    throw "TreeFile.writeNode() failed.";
+
+  where += howMany;
+  }
+}
+
+
+
+void TreeFile::readNode( HeapInt& node )
+{
+const Int32 size = readInt32();
+if( size < 1 )
+  throw "TreeFile.readNode() bad size.";
+
+node.setIndex( size - 1 );
+
+unsigned char bytes[3 * 1024];
+Int32 where = 0;
+while( where < size )
+  {
+  Int32 howMany = size - where;
+  if( howMany > 1024 )
+    howMany = 1024;
+
+  const size_t toRead = static_cast<size_t>(
+                                  howMany * 3 );
+  if( fread( bytes, 1, toRead, file ) != toRead )
+    throw "TreeFile.readNode() failed.";
+
+  for( Int32 count = 0; count < howMany; count++ )
+    {
+    const Int64 digit =
+        static_cast<Int64>( bytes[count * 3] ) |
+        (static_cast<Int64>(
+                 bytes[(count * 3) + 1] ) << 8) |
+        (static_cast<Int64>(
+                 bytes[(count * 3) + 2] ) << 16);
+    node.setD( where + count, digit );
+    }
+
+  where += howMany;
+  }
+
+node.trim();
+}
+
+
+
+DiskTree::DiskTree( const char* setDirectory,
+                    const Int64 setMemoryBudget )
+{
+const Int32 written = snprintf( directory,
+                                MaxDirectory, "%s",
+                                setDirectory );
+if( (written < 0) || (written >= MaxDirectory))
+  throw "DiskTree directory name is too long.";
+
+if( setMemoryBudget < (1024 * 1024) )
+  throw "DiskTree memory budget is too small.";
+
+memoryBudget = setMemoryBudget;
+
+// Three files are open at a time.
+Int64 size = memoryBudget / 16;
+if( size > (64 * 1024 * 1024) )
+  size = 64 * 1024 * 1024;
+
+bufferSize = static_cast<Int32>( size );
+}
+
+
+
+void DiskTree::getFileName( char* name,
+                            const char kind,
+                            const Int32 shard,
+                            const Int32 level ) const
+{
+if( shard == MergeShard )
+  snprintf( name, MaxPath, "%s/merge_%c%d.ptl",
+            directory, kind, level );
+else
+  snprintf( name, MaxPath, "%s/shard%d_%c%d.ptl",
+            directory, shard, kind, level );
+
+}
+
+
+
+// Two operands, the product, and the
+// Karatsuba and remainder arrays, at eight
+// bytes a digit.
+
+void DiskTree::checkBudget( const HeapInt& a,
+                            const HeapInt& b ) const
+{
+const Int64 digits =
+             static_cast<Int64>( a.getIndex()) +
+             static_cast<Int64>( b.getIndex()) + 2;
+if( (digits * 8 * 4) > memoryBudget )
+  throw "DiskTree node is too big for the budget.";
+
+}
+
+
+
+Int32 DiskTree::getTopLevel( const Int32 howMany )
+{
+Int32 level = 0;
+Int32 size = howMany;
+while( size > 1 )
+  {
+  size = (size + 1) / 2;
+  level++;
+  }
+
+return level;
+}
+
+
+
+// Level 0 has to be written already.
+
+void DiskTree::buildUp( const Int32 shard,
+                        const Int32 leafCount )
+{
+char inName[MaxPath];
+char outName[MaxPath];
+const Int32 topLevel = getTopLevel( leafCount );
+
+TreeFile inFile;
+TreeFile outFile;
+HeapInt left;
+HeapInt right;
+HeapInt product;
+for( Int32 level = 0; level < topLevel; level++ )
+  {
+  getFileName( inName, 'n', shard, level );
+  getFileName( outName, 'n', shard, level + 1 );
+  inFile.openRead( inName, bufferSize );
+  const Int32 size = inFile.getNodeCount();
+  outFile.openWrite( outName, (size + 1) / 2,
+                                  bufferSize );
+
+  for( Int32 count = 0; count < size;
+                                   count += 2 )
+    {
+    inFile.readNode( left );
+    if( (count + 1) < size )
+      {
+      inFile.readNode( right );
+      checkBudget( left, right );
+      HeapInt::multiply( left, right, product );
+      outFile.writeNode( product );
+      }
+    else
+      {
+      outFile.writeNode( left );
+      }
+    }
+
+  inFile.close();
+  outFile.close();
+  }
+}
+
+
+
+// The remainder at topLevel has to be written
+// already.  Each node gets its parent's
+// remainder mod that node squared.
+
+void DiskTree::pushDown( const Int32 shard,
+                         const Int32 topLevel )
+{
+char parentName[MaxPath];
+char nodeName[MaxPath];
+char outName[MaxPath];
+
+TreeFile parentFile;
+TreeFile nodeFile;
+TreeFile outFile;
+HeapInt parent;
+HeapInt node;
+HeapInt square;
+HeapInt rem;
+for( Int32 level = topLevel - 1; level >= 0;
+                                       level-- )
+  {
+  getFileName( parentName, 'r', shard, level + 1 );
+  getFileName( nodeName, 'n', shard, level );
+  getFileName( outName, 'r', shard, level );
+  parentFile.openRead( parentName, bufferSize );
+  nodeFile.openRead( nodeName, bufferSize );
+  const Int32 size = nodeFile.getNodeCount();
+  outFile.openWrite( outName, size, bufferSize );
+
+  for( Int32 count = 0; count < size; count++ )
+    {
+    if( (count & 1) == 0 )
+      parentFile.readNode( parent );
+
+    nodeFile.readNode( node );
+    checkBudget( parent, node );
+    HeapInt::multiply( node, node, square );
+    HeapInt::remainder( parent, square, rem );
+    outFile.writeNode( rem );
+    }
+
+  parentFile.close();
+  nodeFile.close();
+  outFile.close();
+  }
+}
+
+
+
+void DiskTree::buildShard( const Integer* moduli,
+                           const Int32 howMany,
+                           const Int32 shard )
+{
+if( (howMany < 1) || (shard < 0) )
+  throw "DiskTree.buildShard() bad values.";
+
+char name[MaxPath];
+getFileName( name, 'n', shard, 0 );
+
+TreeFile outFile;
+outFile.openWrite( name, howMany, bufferSize );
+HeapInt leaf;
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  const Integer& modulus = moduli[count];
+  if( modulus.getNegative() || modulus.isZero())
+    throw "DiskTree modulus is not positive.";
+
+  if( ((modulus.getIndex() + 1) * 2) >=
+                   IntConst::DigitArraySize )
+    throw "DiskTree modulus is too big.";
+
+  leaf.copyFromInteger( modulus );
+  outFile.writeNode( leaf );
+  }
+
+outFile.close();
+
+buildUp( shard, howMany );
+
+// The top goes in its own file so that
+// mergeShards() doesn't need to know how
+// many levels each shard has.
+TreeFile inFile;
+getFileName( name, 'n', shard,
+                    getTopLevel( howMany ));
+inFile.openRead( name, bufferSize );
+inFile.readNode( leaf );
+inFile.close();
+
+getFileName( name, 't', shard, 0 );
+outFile.openWrite( name, 1, bufferSize );
+outFile.writeNode( leaf );
+outFile.close();
+}
+
+
+
+void DiskTree::mergeShards( const Int32 shardCount )
+{
+if( shardCount < 1 )
+  throw "DiskTree.mergeShards() no shards.";
+
+char name[MaxPath];
+TreeFile inFile;
+TreeFile outFile;
+HeapInt node;
+
+getFileName( name, 'n', MergeShard, 0 );
+outFile.openWrite( name, shardCount, bufferSize );
+for( Int32 count = 0; count < shardCount; count++ )
+  {
+  getFileName( name, 't', count, 0 );
+  inFile.openRead( name, bufferSize );
+  inFile.readNode( node );
+  inFile.close();
+  outFile.writeNode( node );
+  }
+
+outFile.close();
+
+buildUp( MergeShard, shardCount );
+
+// P mod P^2 is just P.
+const Int32 topLevel = getTopLevel( shardCount );
+getFileName( name, 'n', MergeShard, topLevel );
+inFile.openRead( name, bufferSize );
+inFile.readNode( node );
+inFile.close();
+
+getFileName( name, 'r', MergeShard, topLevel );
+outFile.openWrite( name, 1, bufferSize );
+outFile.writeNode( node );
+outFile.close();
+
+pushDown( MergeShard, topLevel );
+}
+
+
+
+Int32 DiskTree::finishShard( const Integer* moduli,
+                             const Int32 howMany,
+                             const Int32 shard,
+                             Integer* factors,
+                             IntegerMath& intMath )
+{
+if( (howMany < 1) || (shard < 0) )
+  throw "DiskTree.finishShard() bad values.";
+
+char name[MaxPath];
+TreeFile inFile;
+TreeFile outFile;
+HeapInt rem;
+
+// P mod the top of this shard squared.
+getFileName( name, 'r', MergeShard, 0 );
+inFile.openRead( name, bufferSize );
+if( shard >= inFile.getNodeCount())
+  throw "DiskTree.finishShard() shard is not merged.";
+
+for( Int32 count = 0; count <= shard; count++ )
+  inFile.readNode( rem );
+
+inFile.close();
+
+const Int32 topLevel = getTopLevel( howMany );
+getFileName( name, 'r', shard, topLevel );
+outFile.openWrite( name, 1, bufferSize );
+outFile.writeNode( rem );
+outFile.close();
+
+pushDown( shard, topLevel );
+
+getFileName( name, 'r', shard, 0 );
+inFile.openRead( name, bufferSize );
+if( inFile.getNodeCount() != howMany )
+  throw "DiskTree.finishShard() wrong count.";
+
+Int32 found = 0;
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  inFile.readNode( rem );
+  if( BatchGcd::getSharedFactor( rem,
+                                 moduli[count],
+                                 factors[count],
+                                 intMath ))
+    found++;
+
+  }
+
+inFile.close();
+return found;
+}
+
+
+
+void DiskTree::removeFiles( const Int32 shard,
+                            const Int32 howMany ) const
+{
+char name[MaxPath];
+const Int32 topLevel = getTopLevel( howMany );
+for( Int32 level = 0; level <= topLevel; level++ )
+  {
+  getFileName( name, 'n', shard, level );
+  remove( name );
+  getFileName( name, 'r', shard, level );
+  remove( name );
+  }
+
+getFileName( name, 't', shard, 0 );
+remove( name );
+}
+
+
+
+void DiskTree::removeMergeFiles(
+                  const Int32 shardCount ) const
+{
+removeFiles( MergeShard, shardCount );
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
@@ -0,0 +1,193 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// Batch gcd for more moduli than the product
+// tree can hold in RAM.  Every level of the
+// tree is a file, and a level is streamed
+// from one file in to the next, so only a
+// couple of nodes are in memory at a time.
+
+// The moduli are split up in to shards, and
+// each shard can be done by a separate
+// process on the same machine, all using the
+// same directory:
+//   1. buildShard() for each shard.
+//   2. mergeShards() once, after all of the
+//      shards are built.  It multiplies the
+//      shard tops together and pushes P back
+//      down to them.
+//   3. finishShard() for each shard.
+// Then removeFiles() if they're not wanted.
+
+// In a file a node is its digit count in four
+// bytes and then the 24 bit digits in three
+// bytes each, low byte first, instead of the
+// eight bytes of an Int64.
+
+// How far this goes.  The multiplies are
+// Karatsuba, and the remainders are Barrett
+// with those multiplies, so a remainder of
+// 2n digits by n digits goes up as about
+// n^1.7.  Every node is read whole in to a
+// HeapInt, so the biggest ones have to fit
+// in memory.  For 2048 bit moduli on one
+// core, measured up to 2048 moduli and
+// extrapolated past that:
+//        512 moduli    7 seconds
+//       2048 moduli    74 seconds
+//        32k moduli    about 2 hours
+//       100k moduli    about 13 hours
+//       250k moduli    about 3 days, 1 GB
+//         1M moduli    about 25 days, 4 GB
+//         4M moduli    about 260 days, 16 GB
+// The memory is the budget that the top of
+// pushDown() needs, about 4 KB for each
+// modulus.  The shards can be built in
+// separate processes, but most of the time
+// is in the top levels, which are one
+// process.  So a few hundred thousand
+// moduli is about the limit.  A few million
+// would need an FFT multiply and nodes that
+// are streamed in pieces.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "HeapInt.h"
+
+#include <cstdio>
+
+
+
+// One level of a tree in a file.
+
+class TreeFile
+  {
+  private:
+  bool testForCopy = false;
+  FILE* file = nullptr;
+  char* buffer = nullptr;
+  Int32 nodeCount = 0;
+
+  void writeInt32( const Int32 toWrite );
+  Int32 readInt32( void );
+
+  public:
+  TreeFile( void )
+    {
+    }
+
+  TreeFile( const TreeFile& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "TreeFile copy constructor.";
+    }
+
+  ~TreeFile( void )
+    {
+    close();
+    }
+
+  // This writes the header with setCount.
+  void openWrite( const char* fileName,
+                  const Int32 setCount,
+                  const Int32 bufferSize );
+
+  // This reads the header and nodeCount.
+  void openRead( const char* fileName,
+                 const Int32 bufferSize );
+
+  void close( void );
+
+  inline Int32 getNodeCount( void ) const
+    {
+    return nodeCount;
+    }
+
+  void writeNode( const HeapInt& node );
+  void readNode( HeapInt& node );
+
+  };
+
+
+
+class DiskTree
+  {
+  private:
+  bool testForCopy = false;
+  static const Int32 MaxPath = 1024;
+  static const Int32 MergeShard = -1;
+  static const Int32 MaxDirectory = MaxPath - 64;
+  char directory[MaxDirectory] = { 0 };
+  Int64 memoryBudget = 0;
+  Int32 bufferSize = 0;
+
+  void getFileName( char* name,
+                    const char kind,
+                    const Int32 shard,
+                    const Int32 level ) const;
+
+  void checkBudget( const HeapInt& a,
+                    const HeapInt& b ) const;
+
+  static Int32 getTopLevel( const Int32 howMany );
+
+  void buildUp( const Int32 shard,
+                const Int32 leafCount );
+
+  void pushDown( const Int32 shard,
+                 const Int32 topLevel );
+
+  public:
+  // memoryBudget is in bytes.  It sets the
+  // size of the file buffers, and it throws
+  // if one multiply or remainder would need
+  // more than that.
+  DiskTree( const char* setDirectory,
+            const Int64 setMemoryBudget );
+
+  DiskTree( const DiskTree& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "DiskTree copy constructor.";
+    }
+
+  // moduli is just the ones for this shard.
+  void buildShard( const Integer* moduli,
+                   const Int32 howMany,
+                   const Int32 shard );
+
+  void mergeShards( const Int32 shardCount );
+
+  // The same as BatchGcd::findSharedFactors()
+  // for the moduli in this shard, with the
+  // product of all of the shards.
+  Int32 finishShard( const Integer* moduli,
+                     const Int32 howMany,
+                     const Int32 shard,
+                     Integer* factors,
+                     IntegerMath& intMath );
+
+  void removeFiles( const Int32 shard,
+                    const Int32 howMany ) const;
+
+  void removeMergeFiles(
+                  const Int32 shardCount ) const;
+
+  };
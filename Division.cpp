@@ -23,10 +23,16 @@
 
 
 #include "Division.h"
+#include "DivisionBZ.h"
+#include "Recip24.h"
 #include "../CppBase/StIO.h"
 
 
 
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
 bool Division::shortDivide(
                const Integer& toDivideOriginal,
                const Integer& divideByOriginal,
@@ -143,49 +149,12 @@ if( toDivideOriginal.isLong48())
   return toDiv % divideByU;
   }
 
-Integer toDivide;
-toDivide.copy( toDivideOriginal );
-quotient.copy( toDivide );
-Int64 remainderU = 0;
-if( divideByU > quotient.getD( quotient.
-                                    getIndex() ))
-  {
-  quotient.setD( quotient.getIndex(), 0 );
-  }
-else
-  {
-  Int64 oneDigit = quotient.getD( quotient.
-                                   getIndex() );
-  quotient.setD( quotient.getIndex(), oneDigit /
-                                     divideByU );
-  remainderU = oneDigit % divideByU;
-  toDivide.setD( toDivide.getIndex(), remainderU );
-  }
-
-for( Int32 count = quotient.getIndex();
-                           count >= 1; count-- )
-  {
-  Int64 twoDigits = toDivide.getD( count );
-  twoDigits <<= 24;
-  twoDigits |= toDivide.getD( count - 1 );
-  quotient.setD( count - 1,
-                         twoDigits / divideByU );
-  remainderU = twoDigits % divideByU;
-  toDivide.setD( count, 0 );
-  toDivide.setD( count - 1, remainderU );
-  }
-
-for( Int32 count = quotient.getIndex();
-                            count >= 0; count-- )
-  {
-  if( quotient.getD( count ) != 0 )
-    {
-    quotient.setIndex( count );
-    break;
-    }
-  }
-
-return remainderU;
+// This multiplies by a reciprocal instead
+// of using the divide instruction for
+// each digit.
+Recip24 recip;
+recip.setDivisor( divideByU );
+return recip.divide( toDivideOriginal, quotient );
 }
 
 
@@ -289,9 +258,19 @@ longDivide2( toDivideTest3, divideByTest3,
 
 
 
-longDivide3( toDivide, divideBy,
-                quotient, remainder,
-                intMath );
+// Big divisions with a big quotient are done
+// recursively.
+if( DivisionBZ::canDivide( toDivide, divideBy ))
+  {
+  DivisionBZ::divide( toDivide, divideBy,
+                      quotient, remainder,
+                      intMath );
+  return;
+  }
+
+// longDivide3() is kept for testing against.
+longDivideD( toDivide, divideBy,
+             quotient, remainder, true );
 
 
 /*
@@ -858,3 +837,454 @@ if( divideByKeep.paramIsGreater( remainder ))
   throw "Remainder > DivideBy longDivide3().";
 
 }
+
+
+
+// This is like divide() except that it only
+// finds the remainder.  Mod.makeExact() and
+// NumbSys.setupBaseArray() throw away the
+// quotient anyway, so there's no reason to
+// build it one digit at a time.
+
+// The remainder can be the same object as
+// toDivideOriginal.
+
+void Division::remainderOnly(
+               const Integer& toDivideOriginal,
+               const Integer& divideByOriginal,
+               Integer& remainder,
+               IntegerMath& intMath )
+{
+if( toDivideOriginal.getNegative() )
+  throw "remainderOnly() toDivide is negative.";
+
+if( divideByOriginal.getNegative() )
+  throw "remainderOnly() divideBy is negative.";
+
+if( divideByOriginal.isZero() )
+  throw "remainderOnly() dividing by zero.";
+
+if( toDivideOriginal.paramIsGreater(
+                            divideByOriginal ))
+  {
+  remainder.copy( toDivideOriginal );
+  return;
+  }
+
+if( toDivideOriginal.isEqual( divideByOriginal ))
+  {
+  remainder.setToZero();
+  return;
+  }
+
+if( toDivideOriginal.isLong48() )
+  {
+  Int64 toDivideU = toDivideOriginal.
+                               getAsLong48();
+  Int64 divideByU = divideByOriginal.
+                               getAsLong48();
+  remainder.setFromLong48( toDivideU %
+                                  divideByU );
+  return;
+  }
+
+if( divideByOriginal.getIndex() == 0 )
+  {
+  Int32 remainderU = intMath.getMod24(
+                       toDivideOriginal,
+                       divideByOriginal.getD( 0 ));
+  remainder.setFromInt24( remainderU );
+  return;
+  }
+
+Integer quotient;
+longDivideD( toDivideOriginal,
+             divideByOriginal,
+             quotient, remainder, false );
+}
+
+
+
+// This is Algorithm D from Donald Knuth's
+// The Art of Computer Programming, Volume 2,
+// section 4.3.1, with 24 bit digits.
+
+// v has vSize digits and it has to be
+// normalized, so the 0x800000 bit is set in
+// its top digit.  vSize is at least 2.
+// u has uSize digits, already shifted by the
+// same amount as v, and u[uSize] holds what
+// got shifted out the top.  The quotient goes
+// in q[0] up to q[uSize - vSize], unless q is
+// nullptr.  The remainder is left, still
+// shifted, in u[0] up to u[vSize - 1].
+
+void Division::algorithmD( Int64* u,
+                           const Int32 uSize,
+                           const Int64* v,
+                           const Int32 vSize,
+                           Int64* q )
+{
+if( vSize < 2 )
+  throw "Division.algorithmD() vSize < 2.";
+
+if( uSize < vSize )
+  throw "Division.algorithmD() uSize < vSize.";
+
+const Int64 vTop = v[vSize - 1];
+const Int64 vNext = v[vSize - 2];
+
+if( (vTop & 0x800000) == 0 )
+  throw "Division.algorithmD() not normalized.";
+
+for( Int32 j = uSize - vSize; j >= 0; j-- )
+  {
+  // Estimate the quotient digit from the top
+  // two digits of u and the top digit of v.
+  Int64 twoDigits = u[j + vSize] << 24;
+  twoDigits |= u[j + vSize - 1];
+  Int64 qHat = twoDigits / vTop;
+  Int64 rHat = twoDigits % vTop;
+
+  // Then test it against the next digit of v.
+  // After this qHat is either exactly right or
+  // it is one too high, and that's rare.
+  while( (qHat > Integer::Int24BitMask) ||
+         ((qHat * vNext) >
+          ((rHat << 24) | u[j + vSize - 2])) )
+    {
+    qHat--;
+    rHat += vTop;
+    if( rHat > Integer::Int24BitMask )
+      break;
+
+    }
+
+  // Multiply and subtract in place.
+  Int64 carry = 0;
+  for( Int32 count = 0; count < vSize; count++ )
+    {
+    Int64 product = (qHat * v[count]) + carry;
+    carry = product >> 24;
+    Int64 digit = u[count + j] -
+                  (product & Integer::Int24BitMask);
+    if( digit < 0 )
+      {
+      digit += Integer::Int24BitMask + 1;
+      carry++;
+      }
+
+    u[count + j] = digit;
+    }
+
+  Int64 top = u[j + vSize] - carry;
+  if( top < 0 )
+    {
+    // It was one too high, so add one v back.
+    qHat--;
+    carry = 0;
+    for( Int32 count = 0; count < vSize; count++ )
+      {
+      Int64 total = u[count + j] + v[count] +
+                                       carry;
+      u[count + j] = total & Integer::Int24BitMask;
+      carry = total >> 24;
+      }
+
+    top += carry;
+    }
+
+  if( top != 0 )
+    throw "Division.algorithmD() top not zero.";
+
+  u[j + vSize] = 0;
+
+  if( q != nullptr )
+    q[j] = qHat;
+
+  }
+}
+
+
+
+// This normalizes copies of toDivide and divideBy
+// in to plain arrays so that algorithmD() can
+// work on them in place.  If keepQuotient is
+// false the quotient is not set at all.
+
+// divideBy has to have an index of at least 1.
+// The remainder can be the same object as
+// toDivide.
+
+void Division::longDivideD(
+                        const Integer& toDivide,
+                        const Integer& divideBy,
+                        Integer& quotient,
+                        Integer& remainder,
+                        const bool keepQuotient )
+{
+const Int32 uSize = toDivide.getIndex() + 1;
+const Int32 vSize = divideBy.getIndex() + 1;
+
+if( vSize < 2 )
+  throw "Division.longDivideD() vSize < 2.";
+
+if( uSize < vSize )
+  throw "Division.longDivideD() uSize < vSize.";
+
+Int64 u[IntConst::DigitArraySize + 1];
+Int64 v[IntConst::DigitArraySize];
+Int64 q[IntConst::DigitArraySize];
+
+const Int32 shiftBy = findShiftBy(
+                   divideBy.getD( vSize - 1 ));
+const Int32 shiftBack = 24 - shiftBy;
+
+Int64 carry = 0;
+for( Int32 count = 0; count < vSize; count++ )
+  {
+  Int64 digit = divideBy.getD( count );
+  v[count] = ((digit << shiftBy) &
+                  Integer::Int24BitMask) | carry;
+  carry = digit >> shiftBack;
+  }
+
+carry = 0;
+for( Int32 count = 0; count < uSize; count++ )
+  {
+  Int64 digit = toDivide.getD( count );
+  u[count] = ((digit << shiftBy) &
+                  Integer::Int24BitMask) | carry;
+  carry = digit >> shiftBack;
+  }
+
+u[uSize] = carry;
+
+if( keepQuotient )
+  algorithmD( u, uSize, v, vSize, q );
+else
+  algorithmD( u, uSize, v, vSize, nullptr );
+
+if( keepQuotient )
+  {
+  Int32 qIndex = uSize - vSize;
+  while( (qIndex > 0) && (q[qIndex] == 0) )
+    qIndex--;
+
+  quotient.setToZero();
+  quotient.setIndex( qIndex );
+  for( Int32 count = 0; count <= qIndex; count++ )
+    quotient.setD( count, q[count] );
+
+  }
+
+// Shift the remainder back.
+Int32 rIndex = vSize - 1;
+while( (rIndex > 0) && (u[rIndex] == 0) )
+  rIndex--;
+
+remainder.setToZero();
+remainder.setIndex( rIndex );
+carry = 0;
+for( Int32 count = rIndex; count >= 0; count-- )
+  {
+  Int64 digit = u[count];
+  remainder.setD( count, (digit >> shiftBy) |
+                                       carry );
+  carry = (digit << shiftBack) &
+                          Integer::Int24BitMask;
+  }
+
+if( (rIndex > 0) && (remainder.getD( rIndex ) == 0))
+  remainder.setIndex( rIndex - 1 );
+
+if( divideBy.paramIsGreaterOrEq( remainder ))
+  throw "Remainder >= DivideBy longDivideD().";
+
+}
+
+
+
+
+// The multiplicative inverse of an odd number
+// mod 2^24.  Any odd x is its own inverse
+// mod 2^3, and each Newton step doubles the
+// number of good bits: 3, 6, 12, 24.
+
+Int64 Division::inverseMod24( const Int64 odd )
+{
+if( (odd & 1) == 0 )
+  throw "Division.inverseMod24() not odd.";
+
+Int64 inverse = odd & Integer::Int24BitMask;
+for( Int32 count = 0; count < 3; count++ )
+  {
+  Int64 test = (odd * inverse) &
+                          Integer::Int24BitMask;
+  test = (2 - test) & Integer::Int24BitMask;
+  inverse = (inverse * test) &
+                          Integer::Int24BitMask;
+  }
+
+if( ((odd * inverse) & Integer::Int24BitMask)
+                                       != 1 )
+  throw "Division.inverseMod24() is bad.";
+
+return inverse;
+}
+
+
+
+// This is only for when it's already known
+// that divideBy divides toDivide exactly.
+// If it doesn't, the quotient is garbage.
+
+// Tudor Jebelean, "An algorithm for exact
+// division", Journal of Symbolic Computation
+// 15 (1993).  It works from the bottom digit up.
+// Each quotient digit is the bottom digit of
+// what's left times the inverse of divideBy
+// mod 2^24.  So there are no estimates and no
+// corrections, and the digits above the
+// quotient size never have to be found.
+
+void Division::divideExact(
+                        const Integer& toDivide,
+                        const Integer& divideBy,
+                        Integer& quotient )
+{
+if( toDivide.getNegative() ||
+    divideBy.getNegative() )
+  throw "Division.divideExact() negative.";
+
+if( divideBy.isZero())
+  throw "Division.divideExact() by zero.";
+
+if( toDivide.isZero())
+  {
+  quotient.setToZero();
+  return;
+  }
+
+// divideBy can't be bigger than a number it
+// divides.
+if( toDivide.paramIsGreater( divideBy ))
+  throw "Division.divideExact() too small.";
+
+Int64 u[IntConst::DigitArraySize];
+Int64 v[IntConst::DigitArraySize];
+
+// Zero digits at the bottom of divideBy come
+// off of both.
+Int32 zeros = 0;
+while( divideBy.getD( zeros ) == 0 )
+  {
+  if( toDivide.getD( zeros ) != 0 )
+    throw "Division.divideExact() not exact.";
+
+  zeros++;
+  }
+
+const Int32 uSize = toDivide.getIndex() + 1 -
+                                       zeros;
+const Int32 vSize = divideBy.getIndex() + 1 -
+                                       zeros;
+
+for( Int32 count = 0; count < uSize; count++ )
+  u[count] = toDivide.getD( count + zeros );
+
+for( Int32 count = 0; count < vSize; count++ )
+  v[count] = divideBy.getD( count + zeros );
+
+// Then zero bits so that v[0] is odd.
+Int32 shiftBy = 0;
+while( ((v[0] >> shiftBy) & 1) == 0 )
+  shiftBy++;
+
+if( shiftBy > 0 )
+  {
+  if( (u[0] & ((1 << shiftBy) - 1)) != 0 )
+    throw "Division.divideExact() not exact 2.";
+
+  const Int32 shiftBack = 24 - shiftBy;
+  for( Int32 count = 0; count < uSize; count++ )
+    {
+    Int64 next = 0;
+    if( (count + 1) < uSize )
+      next = u[count + 1];
+
+    u[count] = (u[count] >> shiftBy) |
+           ((next << shiftBack) &
+                        Integer::Int24BitMask);
+    }
+
+  for( Int32 count = 0; count < vSize; count++ )
+    {
+    Int64 next = 0;
+    if( (count + 1) < vSize )
+      next = v[count + 1];
+
+    v[count] = (v[count] >> shiftBy) |
+           ((next << shiftBack) &
+                        Integer::Int24BitMask);
+    }
+  }
+
+const Int64 inverse = inverseMod24( v[0] );
+
+// The quotient has at most this many digits.
+const Int32 qSize = uSize - vSize + 1;
+if( qSize < 1 )
+  throw "Division.divideExact() qSize < 1.";
+
+for( Int32 where = 0; where < qSize; where++ )
+  {
+  const Int64 qDigit = (u[where] * inverse) &
+                          Integer::Int24BitMask;
+
+  // Keep it here until it gets set in to the
+  // quotient.  u[where] becomes zero.
+  Int64 carry = 0;
+  for( Int32 count = where; count < qSize;
+                                       count++ )
+    {
+    Int64 vDigit = 0;
+    if( (count - where) < vSize )
+      vDigit = v[count - where];
+    else
+      {
+      if( carry == 0 )
+        break;
+
+      }
+
+    Int64 product = (qDigit * vDigit) + carry;
+    carry = product >> 24;
+    Int64 digit = u[count] -
+                  (product & Integer::Int24BitMask);
+    if( digit < 0 )
+      {
+      digit += Integer::Int24BitMask + 1;
+      carry++;
+      }
+
+    u[count] = digit;
+    }
+
+  u[where] = qDigit;
+  }
+
+Int32 qIndex = qSize - 1;
+while( (qIndex > 0) && (u[qIndex] == 0) )
+  qIndex--;
+
+quotient.setToZero();
+quotient.setIndex( qIndex );
+for( Int32 count = 0; count <= qIndex; count++ )
+  quotient.setD( count, u[count] );
+
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
@@ -75,4 +75,30 @@ class Division
                       Integer& remainder,
                       IntegerMath& intMath );
 
+  static void remainderOnly(
+                const Integer& toDivideOriginal,
+                const Integer& divideByOriginal,
+                Integer& remainder,
+                IntegerMath& intMath );
+
+  static void algorithmD( Int64* u,
+                          const Int32 uSize,
+                          const Int64* v,
+                          const Int32 vSize,
+                          Int64* q );
+
+  static void longDivideD(
+                      const Integer& toDivide,
+                      const Integer& divideBy,
+                      Integer& quotient,
+                      Integer& remainder,
+                      const bool keepQuotient );
+
+  static Int64 inverseMod24( const Int64 odd );
+
+  static void divideExact(
+                      const Integer& toDivide,
+                      const Integer& divideBy,
+                      Integer& quotient );
+
   };
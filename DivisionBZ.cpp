@@ -0,0 +1,319 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+// Recursive division for big numbers.
+// Christoph Burnikel and Joachim Ziegler,
+// "Fast Recursive Division" (1998).
+
+// The numbers are split in to blocks of n
+// digits.  Dividing a 2n digit number by an
+// n digit number is done with two 3n by 2n
+// divisions, and each of those is one 2n by n
+// division of the top halves and one
+// multiply.  So the work gets done in the
+// multiplies.
+
+
+#include "DivisionBZ.h"
+#include "Division.h"
+
+
+
+// This gets from / B^start, mod B^howMany,
+// where B is 2^24.  So it's a block of digits.
+
+void DivisionBZ::getDigits( const Integer& from,
+                            const Int32 start,
+                            const Int32 howMany,
+                            Integer& toGet )
+{
+toGet.setToZero();
+
+if( start > from.getIndex() )
+  return;
+
+Int32 top = start + howMany - 1;
+if( top > from.getIndex() )
+  top = from.getIndex();
+
+while( (top > start) && (from.getD( top ) == 0) )
+  top--;
+
+toGet.setIndex( top - start );
+for( Int32 count = start; count <= top; count++ )
+  toGet.setD( count - start, from.getD( count ));
+
+}
+
+
+
+// Sets it to B^howMany - 1.
+
+void DivisionBZ::setAllOnes( Integer& toSet,
+                             const Int32 howMany )
+{
+toSet.setToZero();
+toSet.setIndex( howMany - 1 );
+for( Int32 count = 0; count < howMany; count++ )
+  toSet.setD( count, Integer::Int24BitMask );
+
+}
+
+
+
+// b has exactly n digits and it's normalized.
+// a is less than b * B^n.
+
+void DivisionBZ::divide2n1n( const Integer& a,
+                             const Integer& b,
+                             const Int32 n,
+                             Integer& quotient,
+                             Integer& remainder,
+                             IntegerMath& intMath )
+{
+if( ((n & 1) != 0) || (n < threshold) )
+  {
+  Division::divide( a, b, quotient, remainder,
+                                     intMath );
+  return;
+  }
+
+const Int32 half = n >> 1;
+
+// a is [a1, a2, a3, a4] in blocks of half.
+Integer a123;
+Integer a4;
+getDigits( a, half, IntConst::DigitArraySize,
+                                       a123 );
+getDigits( a, 0, half, a4 );
+
+Integer quotient1;
+Integer remainder1;
+divide3n2n( a123, b, half, quotient1,
+                      remainder1, intMath );
+
+// [remainder1, a4]
+if( !remainder1.isZero())
+  remainder1.shiftDigitsLeft( half );
+
+remainder1.add( a4 );
+
+Integer quotient2;
+divide3n2n( remainder1, b, half, quotient2,
+                       remainder, intMath );
+
+// The two halves don't overlap.
+quotient.copy( quotient1 );
+if( !quotient.isZero())
+  quotient.shiftDigitsLeft( half );
+
+quotient.add( quotient2 );
+}
+
+
+
+// b has 2n digits and it's normalized.
+// a is less than b * B^n.
+
+void DivisionBZ::divide3n2n( const Integer& a,
+                             const Integer& b,
+                             const Int32 n,
+                             Integer& quotient,
+                             Integer& remainder,
+                             IntegerMath& intMath )
+{
+Integer a1;
+Integer a12;
+Integer a3;
+Integer b1;
+Integer b2;
+
+getDigits( a, n + n, IntConst::DigitArraySize,
+                                          a1 );
+getDigits( a, n, IntConst::DigitArraySize, a12 );
+getDigits( a, 0, n, a3 );
+getDigits( b, n, n, b1 );
+getDigits( b, 0, n, b2 );
+
+Integer remainder1;
+
+if( a1.paramIsGreater( b1 ))
+  {
+  // a1 < b1.
+  divide2n1n( a12, b1, n, quotient,
+                       remainder1, intMath );
+  }
+else
+  {
+  // a1 can't be more than b1, so they are
+  // equal, and the quotient is B^n - 1.
+  // remainder1 = a12 - (B^n - 1)b1
+  //            = a12 - b1 B^n + b1
+  setAllOnes( quotient, n );
+  Integer b1Shifted;
+  b1Shifted.copy( b1 );
+  b1Shifted.shiftDigitsLeft( n );
+  remainder1.copy( a12 );
+  remainder1.add( b1 );
+  remainder1.subtract( b1Shifted );
+  }
+
+// remainder = [remainder1, a3] - quotient * b2
+Integer product;
+product.copy( quotient );
+intMath.multiply( product, b2 );
+
+remainder.copy( remainder1 );
+if( !remainder.isZero())
+  remainder.shiftDigitsLeft( n );
+
+remainder.add( a3 );
+intMath.subtract( remainder, product );
+
+// The quotient estimate is at most two
+// too high.
+Int32 howMany = 0;
+while( remainder.getNegative())
+  {
+  intMath.add( remainder, b );
+  quotient.decrement();
+  howMany++;
+  if( howMany > 2 )
+    throw "DivisionBZ.divide3n2n() howMany.";
+
+  }
+}
+
+
+
+// It's worth it when both the divisor and
+// the quotient are big.  It also has to have
+// room to shift toDivide over.
+
+bool DivisionBZ::canDivide(
+                     const Integer& toDivide,
+                     const Integer& divideBy )
+{
+const Int32 divSize = divideBy.getIndex() + 1;
+if( divSize < threshold )
+  return false;
+
+if( (toDivide.getIndex() - divideBy.getIndex())
+                                  < threshold )
+  return false;
+
+// toDivide gets shifted by less than
+// divSize / 16 digits plus some bits.
+Int32 extra = (divSize >> 4) + 3;
+if( (toDivide.getIndex() + extra) >=
+                    IntConst::DigitArraySize )
+  return false;
+
+return true;
+}
+
+
+
+void DivisionBZ::divide( const Integer& toDivide,
+                         const Integer& divideBy,
+                         Integer& quotient,
+                         Integer& remainder,
+                         IntegerMath& intMath )
+{
+if( toDivide.getNegative() ||
+    divideBy.getNegative() )
+  throw "DivisionBZ.divide() negative.";
+
+const Int32 divSize = divideBy.getIndex() + 1;
+
+// The block size n is j * m, where m is a
+// power of 2, and j is less than threshold.
+// So the recursion splits it in half until
+// it gets down to j digits.
+Int32 m = 1;
+while( (m * threshold) <= divSize )
+  m <<= 1;
+
+const Int32 j = (divSize + m - 1) / m;
+const Int32 n = j * m;
+
+// Shift both so that b has exactly n digits
+// with the top bit set.
+const Int32 shiftDigits = n - divSize;
+const Int32 shiftBits = Division::findShiftBy(
+                divideBy.getD( divSize - 1 ));
+
+Integer b;
+Integer a;
+b.copy( divideBy );
+b.shiftLeft( shiftBits );
+b.shiftDigitsLeft( shiftDigits );
+a.copy( toDivide );
+a.shiftLeft( shiftBits );
+a.shiftDigitsLeft( shiftDigits );
+
+// t is the number of n digit blocks in a,
+// with room for the top bit of the top block
+// to be zero.  So the top block is less
+// than b.
+Int64 topDigit = a.getD( a.getIndex());
+Int32 bitLength = a.getIndex() * 24;
+while( topDigit != 0 )
+  {
+  bitLength++;
+  topDigit >>= 1;
+  }
+
+const Int32 blockBits = n * 24;
+Int32 t = (bitLength + blockBits) / blockBits;
+if( t < 2 )
+  t = 2;
+
+Integer z;
+Integer block;
+Integer quotientI;
+Integer remainderI;
+
+getDigits( a, (t - 2) * n, n + n, z );
+quotient.setToZero();
+
+for( Int32 count = t - 2; count >= 1; count-- )
+  {
+  divide2n1n( z, b, n, quotientI, remainderI,
+                                     intMath );
+
+  // [remainderI, next block of a]
+  getDigits( a, (count - 1) * n, n, block );
+  z.copy( remainderI );
+  if( !z.isZero())
+    z.shiftDigitsLeft( n );
+
+  z.add( block );
+
+  if( !quotient.isZero())
+    quotient.shiftDigitsLeft( n );
+
+  quotient.add( quotientI );
+  }
+
+divide2n1n( z, b, n, quotientI, remainderI,
+                                   intMath );
+
+if( !quotient.isZero())
+  quotient.shiftDigitsLeft( n );
+
+quotient.add( quotientI );
+
+// Shift the remainder back.
+getDigits( remainderI, shiftDigits,
+           IntConst::DigitArraySize, remainder );
+remainder.shiftRight( shiftBits );
+}
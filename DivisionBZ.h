@@ -0,0 +1,67 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// Recursive division for big numbers.
+// Christoph Burnikel and Joachim Ziegler,
+// "Fast Recursive Division" (1998).
+// Max-Planck-Institut fuer Informatik
+// Research Report MPI-I-98-1-022.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+
+
+class DivisionBZ
+  {
+  private:
+  static void getDigits( const Integer& from,
+                         const Int32 start,
+                         const Int32 howMany,
+                         Integer& toGet );
+
+  static void setAllOnes( Integer& toSet,
+                          const Int32 howMany );
+
+  static void divide2n1n( const Integer& a,
+                          const Integer& b,
+                          const Int32 n,
+                          Integer& quotient,
+                          Integer& remainder,
+                          IntegerMath& intMath );
+
+  static void divide3n2n( const Integer& a,
+                          const Integer& b,
+                          const Int32 n,
+                          Integer& quotient,
+                          Integer& remainder,
+                          IntegerMath& intMath );
+
+  public:
+  // In digits.  Below this it's just
+  // Division.longDivideD().
+  static const Int32 threshold = 48;
+
+  static bool canDivide(
+                    const Integer& toDivide,
+                    const Integer& divideBy );
+
+  static void divide( const Integer& toDivide,
+                      const Integer& divideBy,
+                      Integer& quotient,
+                      Integer& remainder,
+                      IntegerMath& intMath );
+
+  };
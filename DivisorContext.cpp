@@ -0,0 +1,188 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+// See Richard Brent and Paul Zimmermann,
+// Modern Computer Arithmetic, Algorithm 3.5
+// ApproximateReciprocal.
+// And the Handbook of Applied Cryptography,
+// Algorithm 14.42 Barrett modular reduction.
+
+
+#include "DivisorContext.h"
+#include "Division.h"
+
+
+
+// a has n digits and the top bit of its top
+// digit is set.  x is set so that
+// a * x < B^(2n) <= a * (x + 2).
+// B is 2^24.  x has n + 1 digits and its top
+// digit is 1.
+
+// Each level of the recursion gets the
+// reciprocal of the top half of a, then one
+// Newton step doubles the number of correct
+// digits.
+
+void DivisorContext::approxReciprocal(
+                           const Integer& a,
+                           Integer& x,
+                           IntegerMath& intMath )
+{
+const Int32 n = a.getIndex() + 1;
+
+if( n <= 2 )
+  {
+  // x = (B^(2n) - 1) / a.
+  Integer allOnes;
+  allOnes.setDigitAndClear( n + n - 1,
+                       Integer::Int24BitMask );
+  for( Int32 count = 0; count < (n + n - 1);
+                                       count++ )
+    allOnes.setD( count, Integer::Int24BitMask );
+
+  Integer remainder;
+  Division::divide( allOnes, a, x, remainder,
+                                     intMath );
+  return;
+  }
+
+const Int32 low = (n - 1) >> 1;
+const Int32 high = n - low;
+
+Integer aHigh;
+aHigh.copy( a );
+aHigh.shiftDigitsRight( low );
+
+Integer xHigh;
+approxReciprocal( aHigh, xHigh, intMath );
+
+// t = a * xHigh, which is close to
+// B^(n + high).
+Integer t;
+t.copy( a );
+intMath.multiply( t, xHigh );
+
+Integer top;
+top.setDigitAndClear( n + high, 1 );
+while( top.paramIsGreaterOrEq( t ))
+  {
+  xHigh.decrement();
+  t.subtract( a );
+  }
+
+// t = B^(n + high) - t
+top.subtract( t );
+top.shiftDigitsRight( low );
+intMath.multiply( top, xHigh );
+top.shiftDigitsRight( high + high - low );
+
+x.copy( xHigh );
+x.shiftDigitsLeft( low );
+x.add( top );
+}
+
+
+
+void DivisorContext::setDivisor(
+                       const Integer& setTo,
+                       IntegerMath& intMath )
+{
+if( setTo.getNegative() )
+  throw "DivisorContext divisor is negative.";
+
+if( setTo.isZero())
+  throw "DivisorContext divisor is zero.";
+
+divisor.copy( setTo );
+divSize = divisor.getIndex() + 1;
+
+// toDivide can be up to 2 * divSize digits.
+if( ((divSize + divSize) + 2) >=
+                     IntConst::DigitArraySize )
+  throw "DivisorContext divisor is too big.";
+
+shiftBy = Division::findShiftBy(
+              divisor.getD( divisor.getIndex()));
+
+normDivisor.copy( divisor );
+normDivisor.shiftLeft( shiftBy );
+
+approxReciprocal( normDivisor, reciprocal,
+                                  intMath );
+
+// Now make it exactly B^(2n) / normDivisor.
+// It's either right or one too low.
+Integer test;
+Integer top;
+top.setDigitAndClear( divSize + divSize, 1 );
+test.copy( reciprocal );
+test.increment();
+intMath.multiply( test, normDivisor );
+if( test.paramIsGreaterOrEq( top ))
+  reciprocal.increment();
+
+}
+
+
+
+void DivisorContext::divide(
+                       const Integer& toDivide,
+                       Integer& quotient,
+                       Integer& remainder,
+                       IntegerMath& intMath )
+{
+if( divSize == 0 )
+  throw "DivisorContext divisor is not set.";
+
+if( toDivide.getNegative() )
+  throw "DivisorContext toDivide is negative.";
+
+Integer x;
+x.copy( toDivide );
+x.shiftLeft( shiftBy );
+
+// It has to be less than B^(2n).  Anything
+// bigger is just a regular division.
+if( x.getIndex() >= (divSize + divSize) )
+  {
+  Division::divide( toDivide, divisor,
+                    quotient, remainder,
+                    intMath );
+  return;
+  }
+
+quotient.copy( x );
+quotient.shiftDigitsRight( divSize - 1 );
+intMath.multiply( quotient, reciprocal );
+quotient.shiftDigitsRight( divSize + 1 );
+
+Integer product;
+product.copy( quotient );
+intMath.multiply( product, normDivisor );
+
+// The quotient is at most two too low.
+remainder.copy( x );
+remainder.subtract( product );
+Int32 howMany = 0;
+while( normDivisor.paramIsGreaterOrEq(
+                                   remainder ))
+  {
+  remainder.subtract( normDivisor );
+  quotient.increment();
+  howMany++;
+  if( howMany > 2 )
+    throw "DivisorContext.divide() howMany.";
+
+  }
+
+remainder.shiftRight( shiftBy );
+}
@@ -0,0 +1,73 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// For dividing lots of numbers by the same
+// divisor.  The reciprocal of the divisor is
+// found once with Newton's method, then each
+// division is two multiplies and a small
+// correction.  (Barrett's method.)
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+
+
+
+class DivisorContext
+  {
+  private:
+  bool testForCopy = false;
+  Integer divisor;
+  Integer normDivisor;
+  Integer reciprocal;
+  Int32 shiftBy = 0;
+  Int32 divSize = 0;
+
+  static void approxReciprocal(
+                           const Integer& a,
+                           Integer& x,
+                           IntegerMath& intMath );
+
+  public:
+  DivisorContext( void )
+    {
+    }
+
+  DivisorContext( const DivisorContext& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "DivisorContext copy constructor.";
+    }
+
+  ~DivisorContext( void )
+    {
+    }
+
+  inline const Integer& getDivisor( void ) const
+    {
+    return divisor;
+    }
+
+  void setDivisor( const Integer& setTo,
+                   IntegerMath& intMath );
+
+  void divide( const Integer& toDivide,
+               Integer& quotient,
+               Integer& remainder,
+               IntegerMath& intMath );
+
+  };
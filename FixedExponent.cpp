@@ -0,0 +1,155 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "FixedExponent.h"
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+Int32 FixedExponent::getBit( const Integer& from,
+                             const Int32 where )
+{
+return static_cast<Int32>(
+              (from.getD( where / 24 ) >>
+                         (where % 24)) & 1 );
+}
+
+
+
+// This returns how many multiplies and
+// squarings it takes with that window size.
+// If keep is true it writes the steps too.
+
+Int32 FixedExponent::recode(
+                        const Int32 setWindowBits,
+                        const bool keep )
+{
+// b^2 and then each odd power after b.
+Int32 cost = 0;
+if( setWindowBits > 1 )
+  cost = 1 << (setWindowBits - 1);
+
+Int32 steps = 0;
+Int32 pending = 0;
+Int32 where = bitLength - 1;
+while( where >= 0 )
+  {
+  if( getBit( exponent, where ) == 0 )
+    {
+    pending++;
+    where--;
+    continue;
+    }
+
+  // The window goes down to the lowest one
+  // bit it can reach, so the digit is odd.
+  Int32 low = where - setWindowBits + 1;
+  if( low < 0 )
+    low = 0;
+
+  while( getBit( exponent, low ) == 0 )
+    low++;
+
+  Int32 digit = 0;
+  for( Int32 bit = where; bit >= low; bit-- )
+    digit = (digit << 1) | getBit( exponent, bit );
+
+  // The first step starts from the table, so
+  // it has nothing to square.
+  if( steps > 0 )
+    pending += where - low + 1;
+
+  if( keep )
+    {
+    squarings[steps] = pending;
+    digits[steps] = digit;
+    }
+
+  cost += pending;
+  if( steps > 0 )
+    cost++;
+
+  steps++;
+  pending = 0;
+  where = low - 1;
+  }
+
+if( pending > 0 )
+  {
+  if( keep )
+    {
+    squarings[steps] = pending;
+    digits[steps] = 0;
+    }
+
+  cost += pending;
+  steps++;
+  }
+
+if( keep )
+  stepCount = steps;
+
+return cost;
+}
+
+
+
+void FixedExponent::setExponent(
+                         const Integer& setFrom )
+{
+if( setFrom.getNegative())
+  throw "FixedExponent is negative.";
+
+exponent.copy( setFrom );
+
+delete[] squarings;
+delete[] digits;
+squarings = nullptr;
+digits = nullptr;
+stepCount = 0;
+windowBits = 1;
+bitLength = 0;
+
+if( exponent.isZero())
+  return;
+
+bitLength = exponent.getIndex() * 24;
+Int64 top = exponent.getD( exponent.getIndex());
+while( top != 0 )
+  {
+  bitLength++;
+  top >>= 1;
+  }
+
+Int32 bestCost = recode( 1, false );
+for( Int32 bits = 2; bits <= MaxWindowBits;
+                                      bits++ )
+  {
+  const Int32 cost = recode( bits, false );
+  if( cost < bestCost )
+    {
+    bestCost = cost;
+    windowBits = bits;
+    }
+  }
+
+// There can't be more steps than bits, plus
+// one for the zeros at the bottom.
+squarings = new Int32[bitLength + 1];
+digits = new Int32[bitLength + 1];
+recode( windowBits, true );
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
@@ -0,0 +1,120 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// An exponent that gets used over and over,
+// like 65537 for RSA public keys, or d for
+// one private key.  It is recoded once in to
+// sliding windows of odd digits, and then
+// Mod::toPower() just follows the steps.
+// Each step is some squarings and then a
+// multiply by an odd power of the base from
+// a table.
+
+// The window size is picked by counting
+// exactly how many multiplies each size
+// would take, table included, so a small
+// exponent gets the shortest chain this can
+// make.  For 3 that is one squaring and one
+// multiply, and for 65537 it is 16
+// squarings and one multiply, with no table.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+
+
+
+class FixedExponent
+  {
+  private:
+  bool testForCopy = false;
+  static const Int32 MaxWindowBits = 6;
+  Int32 windowBits = 1;
+  Int32 stepCount = 0;
+  Int32 bitLength = 0;
+
+  // The squarings before each step, and the
+  // odd digit to multiply by after them.  A
+  // digit of zero means there is no
+  // multiply, which is only for the zeros at
+  // the bottom.
+  Int32* squarings = nullptr;
+  Int32* digits = nullptr;
+
+  Integer exponent;
+
+  static Int32 getBit( const Integer& from,
+                       const Int32 where );
+  Int32 recode( const Int32 setWindowBits,
+                const bool keep );
+
+  public:
+  FixedExponent( void )
+    {
+    }
+
+  FixedExponent( const FixedExponent& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "FixedExponent copy constructor.";
+    }
+
+  ~FixedExponent( void )
+    {
+    delete[] squarings;
+    delete[] digits;
+    }
+
+  void setExponent( const Integer& setFrom );
+
+  inline const Integer& getExponent( void ) const
+    {
+    return exponent;
+    }
+
+  inline bool isZero( void ) const
+    {
+    return stepCount == 0;
+    }
+
+  inline Int32 getWindowBits( void ) const
+    {
+    return windowBits;
+    }
+
+  // The table has the odd powers 1, 3, 5 and
+  // on up to 2^windowBits - 1.
+  inline Int32 getTableSize( void ) const
+    {
+    return 1 << (windowBits - 1);
+    }
+
+  inline Int32 getStepCount( void ) const
+    {
+    return stepCount;
+    }
+
+  inline Int32 getSquarings( const Int32 step ) const
+    {
+    return squarings[step];
+    }
+
+  inline Int32 getDigit( const Int32 step ) const
+    {
+    return digits[step];
+    }
+
+  };
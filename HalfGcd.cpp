@@ -0,0 +1,634 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "HalfGcd.h"
+#include "LehmerGcd.h"
+#include "Division.h"
+
+
+
+
+Int32 HalfGcd::getSize( const Integer& x )
+{
+if( x.isZero())
+  return 0;
+
+return x.getIndex() + 1;
+}
+
+
+
+void HalfGcd::trim( Integer& x )
+{
+Int32 top = x.getIndex();
+while( (top > 0) && (x.getD( top ) == 0) )
+  top--;
+
+x.setIndex( top );
+}
+
+
+
+// The bottom p digits of x.
+
+void HalfGcd::getLow( Integer& result,
+                      const Integer& x,
+                      const Int32 p )
+{
+if( x.getIndex() < p )
+  {
+  result.copy( x );
+  return;
+  }
+
+result.copyUpTo( x, p - 1 );
+trim( result );
+}
+
+
+
+// The Euclid steps on the top 48 bits, the
+// same as LehmerGcd::lehmerMatrix(), except
+// that it stops before a remainder gets
+// below limit, and it gives the matrix the
+// way hgcd() wants it.  That is, with
+// nonnegative entries and with
+// (aHat, bHat) = M1 (newA, newB).  The
+// numbers are never swapped, so the smaller
+// one gets reduced by the larger one.
+
+bool HalfGcd::hgcd2( Int64 aHat,
+                     Int64 bHat,
+                     const Int64 limit,
+                     Int64* matrix )
+{
+bool swapped = false;
+if( aHat < bHat )
+  {
+  const Int64 temp = aHat;
+  aHat = bHat;
+  bHat = temp;
+  swapped = true;
+  }
+
+Int64 A = 1;
+Int64 B = 0;
+Int64 C = 0;
+Int64 D = 1;
+Int32 count = 0;
+while( true )
+  {
+  const Int64 denom1 = bHat + C;
+  const Int64 denom2 = bHat + D;
+  if( (denom1 <= 0) || (denom2 <= 0) )
+    break;
+
+  const Int64 q = (aHat + A) / denom1;
+  if( q != ((aHat + B) / denom2) )
+    break;
+
+  const Int64 rem = aHat - (q * bHat);
+  if( rem < limit )
+    break;
+
+  Int64 temp = A - (q * C);
+  A = C;
+  C = temp;
+
+  temp = B - (q * D);
+  B = D;
+  D = temp;
+
+  aHat = bHat;
+  bHat = rem;
+  count++;
+  }
+
+if( count == 0 )
+  return false;
+
+// [A B; C D] is the inverse of M1 with the
+// rows swapped after each step.  Its
+// determinant is -1 to the count.
+Int64 u00 = D;
+Int64 u01 = -B;
+Int64 u10 = -C;
+Int64 u11 = A;
+if( (count & 1) != 0 )
+  {
+  u00 = B;
+  u01 = -D;
+  u10 = -A;
+  u11 = C;
+  }
+
+if( swapped )
+  {
+  matrix[0] = u11;
+  matrix[1] = u10;
+  matrix[2] = u01;
+  matrix[3] = u00;
+  }
+else
+  {
+  matrix[0] = u00;
+  matrix[1] = u01;
+  matrix[2] = u10;
+  matrix[3] = u11;
+  }
+
+return true;
+}
+
+
+
+// M = M * M1, where M1 is small.
+
+void HalfGcd::multiplyByWords( GcdMatrix& M,
+                               const Int64* m1,
+                               IntegerMath& intMath )
+{
+Integer temp0;
+Integer temp1;
+
+LehmerGcd::combine( temp0, m1[0], M.m00,
+                    m1[2], M.m01, intMath );
+LehmerGcd::combine( temp1, m1[1], M.m00,
+                    m1[3], M.m01, intMath );
+M.m00.copy( temp0 );
+M.m01.copy( temp1 );
+
+LehmerGcd::combine( temp0, m1[0], M.m10,
+                    m1[2], M.m11, intMath );
+LehmerGcd::combine( temp1, m1[1], M.m10,
+                    m1[3], M.m11, intMath );
+M.m10.copy( temp0 );
+M.m11.copy( temp1 );
+}
+
+
+
+// result = (p * x) + (q * y) with signs.
+
+void HalfGcd::multiplySum( Integer& result,
+                           const Integer& p,
+                           const Integer& x,
+                           const Integer& q,
+                           const Integer& y,
+                           IntegerMath& intMath )
+{
+Integer second;
+
+result.copy( p );
+intMath.multiply( result, x );
+second.copy( q );
+intMath.multiply( second, y );
+intMath.add( result, second );
+}
+
+
+
+// M = M * M1.
+
+void HalfGcd::multiply( GcdMatrix& M,
+                        const GcdMatrix& M1,
+                        IntegerMath& intMath )
+{
+Integer temp0;
+Integer temp1;
+
+multiplySum( temp0, M.m00, M1.m00,
+             M.m01, M1.m10, intMath );
+multiplySum( temp1, M.m00, M1.m01,
+             M.m01, M1.m11, intMath );
+M.m00.copy( temp0 );
+M.m01.copy( temp1 );
+
+multiplySum( temp0, M.m10, M1.m00,
+             M.m11, M1.m10, intMath );
+multiplySum( temp1, M.m10, M1.m01,
+             M.m11, M1.m11, intMath );
+M.m10.copy( temp0 );
+M.m11.copy( temp1 );
+}
+
+
+
+// One division step.  It reduces the larger
+// one by the smaller one, but it won't let
+// the remainder get down to s digits or
+// less.  With s = 0 it is the plain Euclid
+// step.
+
+bool HalfGcd::subDivStep( Integer& a,
+                          Integer& b,
+                          const Int32 s,
+                          GcdMatrix* M,
+                          IntegerMath& intMath )
+{
+const bool aIsBig = !a.paramIsGreater( b );
+Integer& big = aIsBig ? a : b;
+Integer& small = aIsBig ? b : a;
+
+if( getSize( small ) <= s )
+  return false;
+
+Integer quotient;
+Integer remainder;
+Division::divide( big, small, quotient,
+                  remainder, intMath );
+
+if( (s > 0) && (getSize( remainder ) <= s) )
+  {
+  // The quotient is one too big for this.
+  if( quotient.isOne())
+    return false;
+
+  quotient.decrement();
+  remainder.add( small );
+  }
+
+big.copy( remainder );
+if( M == nullptr )
+  return true;
+
+// The entries are all positive so this can
+// use Integer::add().
+Integer temp;
+if( aIsBig )
+  {
+  // a = a - (q * b)
+  temp.copy( quotient );
+  intMath.multiply( temp, M->m00 );
+  M->m01.add( temp );
+  temp.copy( quotient );
+  intMath.multiply( temp, M->m10 );
+  M->m11.add( temp );
+  }
+else
+  {
+  temp.copy( quotient );
+  intMath.multiply( temp, M->m01 );
+  M->m00.add( temp );
+  temp.copy( quotient );
+  intMath.multiply( temp, M->m11 );
+  M->m10.add( temp );
+  }
+
+return true;
+}
+
+
+
+// One hgcd step.  It tries the Euclid steps
+// on the top 48 bits first, like Lehmer.
+// Both numbers have to stay more than
+// s digits.
+
+bool HalfGcd::step( Integer& a,
+                    Integer& b,
+                    const Int32 s,
+                    GcdMatrix& M,
+                    IntegerMath& intMath )
+{
+if( (getSize( a ) <= s) || (getSize( b ) <= s) )
+  return false;
+
+const Integer& larger = a.paramIsGreater( b ) ?
+                                        b : a;
+Int32 shiftBy = LehmerGcd::getBitLength(
+                                larger ) - 48;
+if( shiftBy < 0 )
+  shiftBy = 0;
+
+// A remainder has to be at least B^s.
+const Int32 limitBits = (s * 24) - shiftBy;
+if( limitBits < 46 )
+  {
+  Int64 limit = 1;
+  if( limitBits > 0 )
+    limit = 1LL << limitBits;
+
+  Int64 m1[4];
+  if( hgcd2( LehmerGcd::getTop48( a, shiftBy ),
+             LehmerGcd::getTop48( b, shiftBy ),
+             limit, m1 ))
+    {
+    // (newA, newB) = M1^-1 (a, b)
+    Integer newA;
+    Integer newB;
+    LehmerGcd::combine( newA, m1[3], a,
+                        -m1[1], b, intMath );
+    LehmerGcd::combine( newB, -m1[2], a,
+                        m1[0], b, intMath );
+
+    // The top bits only give an estimate of
+    // where the remainders are, so check it.
+    if( !newA.getNegative() &&
+        !newB.getNegative() &&
+        (getSize( newA ) > s) &&
+        (getSize( newB ) > s) )
+      {
+      a.copy( newA );
+      b.copy( newB );
+      multiplyByWords( M, m1, intMath );
+      return true;
+      }
+    }
+  }
+
+return subDivStep( a, b, s, &M, intMath );
+}
+
+
+
+// This calls hgcd() on the digits above p,
+// and then uses the matrix it gets on the
+// whole numbers.  With a = (aHi * B^p) + aLo
+// the new a is (alpha * B^p) +
+// (m11 * aLo) - (m01 * bLo), where alpha is
+// what hgcd() reduced aHi to.  The new b is
+// the same way.
+
+bool HalfGcd::reduceTop( Integer& a,
+                         Integer& b,
+                         const Int32 p,
+                         GcdMatrix& M1,
+                         IntegerMath& intMath )
+{
+Integer aHi;
+Integer bHi;
+aHi.copy( a );
+aHi.shiftDigitsRight( p );
+bHi.copy( b );
+bHi.shiftDigitsRight( p );
+
+M1.setToIdentity();
+if( !hgcd( aHi, bHi, M1, intMath ))
+  return false;
+
+Integer aLo;
+Integer bLo;
+Integer temp;
+getLow( aLo, a, p );
+getLow( bLo, b, p );
+
+a.copy( M1.m11 );
+intMath.multiply( a, aLo );
+temp.copy( M1.m01 );
+intMath.multiply( temp, bLo );
+intMath.subtract( a, temp );
+if( !aHi.isZero())
+  aHi.shiftDigitsLeft( p );
+
+intMath.add( a, aHi );
+
+b.copy( M1.m00 );
+intMath.multiply( b, bLo );
+temp.copy( M1.m10 );
+intMath.multiply( temp, aLo );
+intMath.subtract( b, temp );
+if( !bHi.isZero())
+  bHi.shiftDigitsLeft( p );
+
+intMath.add( b, bHi );
+
+if( a.getNegative() || b.getNegative())
+  throw "HalfGcd.reduceTop() negative.";
+
+return true;
+}
+
+
+
+// a and b are n digits.  This reduces them
+// with M = M * M1, until a step would make
+// one of them s = n/2 + 1 digits or less.
+// It returns false if it couldn't do
+// anything.
+
+bool HalfGcd::hgcd( Integer& a,
+                    Integer& b,
+                    GcdMatrix& M,
+                    IntegerMath& intMath )
+{
+Int32 n = getSize( a );
+if( n < getSize( b ))
+  n = getSize( b );
+
+const Int32 s = (n / 2) + 1;
+if( n <= s )
+  return false;
+
+bool progress = false;
+if( n >= HgcdThreshold )
+  {
+  GcdMatrix M1;
+  if( reduceTop( a, b, n / 2, M1, intMath ))
+    {
+    multiply( M, M1, intMath );
+    progress = true;
+    }
+
+  const Int32 n2 = ((3 * n) / 4) + 1;
+  while( true )
+    {
+    n = getSize( a );
+    if( n < getSize( b ))
+      n = getSize( b );
+
+    if( n <= n2 )
+      break;
+
+    if( !step( a, b, s, M, intMath ))
+      return progress;
+
+    progress = true;
+    }
+
+  if( n > (s + 2) )
+    {
+    if( reduceTop( a, b, (2 * s) - n + 1,
+                   M1, intMath ))
+      {
+      multiply( M, M1, intMath );
+      progress = true;
+      }
+    }
+  }
+
+while( step( a, b, s, M, intMath ))
+  progress = true;
+
+return progress;
+}
+
+
+
+// This reduces a and b until they are below
+// GcdThreshold or until one of them is zero.
+// If P is not null it keeps P = P * M.
+
+void HalfGcd::reduce( Integer& a,
+                      Integer& b,
+                      GcdMatrix* P,
+                      IntegerMath& intMath )
+{
+GcdMatrix M1;
+while( true )
+  {
+  Int32 n = getSize( a );
+  if( n < getSize( b ))
+    n = getSize( b );
+
+  if( n < GcdThreshold )
+    return;
+
+  if( reduceTop( a, b, n / 3, M1, intMath ))
+    {
+    if( P != nullptr )
+      multiply( *P, M1, intMath );
+
+    continue;
+    }
+
+  if( !subDivStep( a, b, 0, P, intMath ))
+    return;
+
+  }
+}
+
+
+
+void HalfGcd::gcd( const Integer& x,
+                   const Integer& y,
+                   Integer& gcd,
+                   IntegerMath& intMath )
+{
+if( x.getNegative() || y.getNegative())
+  throw "HalfGcd.gcd() negative.";
+
+if( (getSize( x ) < GcdThreshold) &&
+    (getSize( y ) < GcdThreshold))
+  {
+  LehmerGcd::gcd( x, y, gcd, intMath );
+  return;
+  }
+
+Integer a;
+Integer b;
+a.copy( x );
+b.copy( y );
+reduce( a, b, nullptr, intMath );
+LehmerGcd::gcd( a, b, gcd, intMath );
+}
+
+
+
+void HalfGcd::extendedGcd( const Integer& x,
+                           const Integer& y,
+                           Integer& gcd,
+                           Integer& u,
+                           Integer& v,
+                           IntegerMath& intMath )
+{
+if( x.getNegative() || y.getNegative())
+  throw "HalfGcd.extendedGcd() negative.";
+
+if( (getSize( x ) < GcdThreshold) &&
+    (getSize( y ) < GcdThreshold))
+  {
+  LehmerGcd::extendedGcd( x, y, gcd, u, v,
+                                   intMath );
+  return;
+  }
+
+Integer a;
+Integer b;
+a.copy( x );
+b.copy( y );
+GcdMatrix P;
+reduce( a, b, &P, intMath );
+
+// gcd = (u1 * a) + (v1 * b) and
+// (a, b) = P^-1 (x, y), so
+// a = (p11 * x) - (p01 * y) and
+// b = (p00 * y) - (p10 * x).
+Integer u1;
+Integer v1;
+Integer temp;
+LehmerGcd::extendedGcd( a, b, gcd, u1, v1,
+                                   intMath );
+
+u.copy( u1 );
+intMath.multiply( u, P.m11 );
+temp.copy( v1 );
+intMath.multiply( temp, P.m10 );
+intMath.subtract( u, temp );
+
+v.copy( v1 );
+intMath.multiply( v, P.m00 );
+temp.copy( u1 );
+intMath.multiply( temp, P.m01 );
+intMath.subtract( v, temp );
+}
+
+
+
+bool HalfGcd::multInverse( const Integer& x,
+                           const Integer& modulus,
+                           Integer& inverse,
+                           Integer& gcd,
+                           IntegerMath& intMath )
+{
+if( x.getNegative() || modulus.getNegative() ||
+    modulus.isZero())
+  throw "HalfGcd.multInverse() bad values.";
+
+if( getSize( modulus ) < GcdThreshold )
+  return LehmerGcd::multInverse( x, modulus,
+                       inverse, gcd, intMath );
+
+Integer reduced;
+reduced.copy( x );
+if( modulus.paramIsGreaterOrEq( reduced ))
+  Division::remainderOnly( reduced, modulus,
+                           reduced, intMath );
+
+if( reduced.isZero())
+  {
+  gcd.copy( modulus );
+  return false;
+  }
+
+Integer u;
+Integer v;
+extendedGcd( reduced, modulus, gcd, u, v,
+                                   intMath );
+if( !gcd.isOne())
+  return false;
+
+// u could be negative and it could be more
+// than the modulus.
+const bool isNeg = u.getNegative();
+u.setNegative( false );
+Division::remainderOnly( u, modulus, u,
+                                   intMath );
+if( isNeg && !u.isZero())
+  {
+  inverse.copy( modulus );
+  intMath.subtract( inverse, u );
+  return true;
+  }
+
+inverse.copy( u );
+return true;
+}
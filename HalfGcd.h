@@ -0,0 +1,178 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// The subquadratic half gcd.  See Niels
+// Moller, "On Schonhage's algorithm and
+// subquadratic integer gcd computation",
+// Mathematics of Computation 77 (2008).
+// It is the same layout as mpn_hgcd() in
+// GMP.
+
+// hgcd() takes a and b that are n digits
+// and reduces them until they are about n/2
+// digits.  It does that by calling itself on
+// the top half of the digits, and then using
+// the matrix it gets on the whole numbers
+// with IntegerMath::multiply().  So the
+// quotients for the top half are all found
+// without ever touching the bottom digits.
+
+// The matrix M always has nonnegative
+// entries and a determinant of 1, and
+// (A, B) = M (a, b), where A and B are the
+// numbers it started with.
+
+// IntegerMath::multiply() is the schoolbook
+// multiply, so the matrix products cost as
+// much as the steps they save.  When I
+// timed it, it only got even with LehmerGcd
+// for the gcd at about 680 digits, which is
+// close to the biggest an Integer can be, and
+// the inverse was still a little slower
+// there.  So below GcdThreshold it just
+// calls LehmerGcd, and Mod still uses
+// LehmerGcd.  It would start to win with a
+// faster multiply.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+
+
+
+class GcdMatrix
+  {
+  private:
+  bool testForCopy = false;
+
+  public:
+  Integer m00;
+  Integer m01;
+  Integer m10;
+  Integer m11;
+
+  GcdMatrix( void )
+    {
+    setToIdentity();
+    }
+
+  GcdMatrix( const GcdMatrix& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "GcdMatrix copy constructor.";
+    }
+
+  inline void setToIdentity( void )
+    {
+    m00.setToOne();
+    m01.setToZero();
+    m10.setToZero();
+    m11.setToOne();
+    }
+
+  };
+
+
+
+class HalfGcd
+  {
+  private:
+  // In digits.  hgcd() calls itself on the
+  // top half when n is at least this.
+  static const Int32 HgcdThreshold = 40;
+
+  // In digits.  Below this the gcd is done
+  // with LehmerGcd.
+  static const Int32 GcdThreshold = 600;
+
+  static Int32 getSize( const Integer& x );
+  static void trim( Integer& x );
+  static void getLow( Integer& result,
+                      const Integer& x,
+                      const Int32 p );
+
+  static bool hgcd2( Int64 aHat,
+                     Int64 bHat,
+                     const Int64 limit,
+                     Int64* matrix );
+
+  static void multiplyByWords( GcdMatrix& M,
+                               const Int64* m1,
+                               IntegerMath& intMath );
+
+  static void multiply( GcdMatrix& M,
+                        const GcdMatrix& M1,
+                        IntegerMath& intMath );
+
+  static void multiplySum( Integer& result,
+                           const Integer& p,
+                           const Integer& x,
+                           const Integer& q,
+                           const Integer& y,
+                           IntegerMath& intMath );
+
+  static bool subDivStep( Integer& a,
+                          Integer& b,
+                          const Int32 s,
+                          GcdMatrix* M,
+                          IntegerMath& intMath );
+
+  static bool step( Integer& a,
+                    Integer& b,
+                    const Int32 s,
+                    GcdMatrix& M,
+                    IntegerMath& intMath );
+
+  static bool reduceTop( Integer& a,
+                         Integer& b,
+                         const Int32 p,
+                         GcdMatrix& M1,
+                         IntegerMath& intMath );
+
+  static bool hgcd( Integer& a,
+                    Integer& b,
+                    GcdMatrix& M,
+                    IntegerMath& intMath );
+
+  static void reduce( Integer& a,
+                      Integer& b,
+                      GcdMatrix* P,
+                      IntegerMath& intMath );
+
+  public:
+  static void gcd( const Integer& x,
+                   const Integer& y,
+                   Integer& gcd,
+                   IntegerMath& intMath );
+
+  // gcd = (u * x) + (v * y), where u and v
+  // can be negative.
+  static void extendedGcd( const Integer& x,
+                           const Integer& y,
+                           Integer& gcd,
+                           Integer& u,
+                           Integer& v,
+                           IntegerMath& intMath );
+
+  // The same as Euclid::multInverse().
+  static bool multInverse( const Integer& x,
+                           const Integer& modulus,
+                           Integer& inverse,
+                           Integer& gcd,
+                           IntegerMath& intMath );
+
+  };
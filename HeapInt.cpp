@@ -0,0 +1,761 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "HeapInt.h"
+#include "Division.h"
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+void HeapInt::setCapacity( const Int32 howMany )
+{
+if( howMany <= last )
+  return;
+
+if( howMany < 1 )
+  throw "HeapInt.setCapacity() range.";
+
+Int64* newD = new Int64[howMany];
+if( D != nullptr )
+  {
+  for( Int32 count = 0; count <= index; count++ )
+    newD[count] = D[count];
+
+  delete[] D;
+  }
+
+D = newD;
+last = howMany;
+}
+
+
+
+void HeapInt::setIndex( const Int32 setTo )
+{
+if( setTo < 0 )
+  throw "HeapInt.setIndex() range.";
+
+if( setTo >= last )
+  {
+  // Grow by at least half so that setting
+  // it one digit at a time is not slow.
+  Int32 newLast = last + (last / 2);
+  if( newLast <= setTo )
+    newLast = setTo + 1;
+
+  setCapacity( newLast );
+  }
+
+index = setTo;
+}
+
+
+
+Int64 HeapInt::getBitLength( void ) const
+{
+Int64 top = D[index];
+Int64 bits = 0;
+while( top != 0 )
+  {
+  top >>= 1;
+  bits++;
+  }
+
+return (static_cast<Int64>( index ) * 24) +
+                                        bits;
+}
+
+
+
+void HeapInt::trim( void )
+{
+while( (index > 0) && (D[index] == 0) )
+  index--;
+
+}
+
+
+
+void HeapInt::copy( const HeapInt& from )
+{
+if( &from == this )
+  return;
+
+setCapacity( from.index + 1 );
+index = from.index;
+for( Int32 count = 0; count <= index; count++ )
+  D[count] = from.D[count];
+
+}
+
+
+
+void HeapInt::copyFromInteger( const Integer& from )
+{
+if( from.getNegative())
+  throw "HeapInt.copyFromInteger() negative.";
+
+setIndex( from.getIndex());
+for( Int32 count = 0; count <= index; count++ )
+  D[count] = from.getD( count );
+
+}
+
+
+
+void HeapInt::copyToInteger( Integer& to ) const
+{
+if( index >= (IntConst::DigitArraySize - 1) )
+  throw "HeapInt.copyToInteger() too big.";
+
+to.setToZero();
+to.setIndex( index );
+for( Int32 count = 0; count <= index; count++ )
+  to.setD( count, D[count] );
+
+}
+
+
+
+// result has aSize + bSize digits.
+
+void HeapInt::multiplyBasic( const Int64* a,
+                             const Int32 aSize,
+                             const Int64* b,
+                             const Int32 bSize,
+                             Int64* result )
+{
+const Int32 max = aSize + bSize;
+for( Int32 count = 0; count < max; count++ )
+  result[count] = 0;
+
+for( Int32 row = 0; row < aSize; row++ )
+  {
+  const Int64 digit = a[row];
+  if( digit == 0 )
+    continue;
+
+  Int64 carry = 0;
+  for( Int32 col = 0; col < bSize; col++ )
+    {
+    const Int64 total = result[row + col] +
+                      (digit * b[col]) + carry;
+    result[row + col] = total &
+                        Integer::Int24BitMask;
+    carry = total >> 24;
+    }
+
+  result[row + bSize] = carry;
+  }
+}
+
+
+
+// a and b are both n digits, and result has
+// 2n digits.  With a = (a1 * B^m) + a0 and
+// the same for b, the middle part is
+// ((a0 + a1) * (b0 + b1)) - (a0 * b0) -
+// (a1 * b1), so it is three multiplies of
+// half the size instead of four.
+
+void HeapInt::karatsuba( const Int64* a,
+                         const Int64* b,
+                         const Int32 n,
+                         Int64* result )
+{
+if( n < KaratsubaThreshold )
+  {
+  multiplyBasic( a, n, b, n, result );
+  return;
+  }
+
+const Int32 m = n / 2;
+const Int32 h = n - m;
+
+// a0 * b0 goes in the bottom 2m digits and
+// a1 * b1 goes in the top 2h digits.
+karatsuba( a, b, m, result );
+karatsuba( a + m, b + m, h, result + (2 * m));
+
+const Int32 sumSize = h + 1;
+Int64* sums = new Int64[2 * sumSize];
+Int64* aSum = sums;
+Int64* bSum = sums + sumSize;
+
+Int64 aCarry = 0;
+Int64 bCarry = 0;
+for( Int32 count = 0; count < h; count++ )
+  {
+  Int64 aTotal = a[m + count] + aCarry;
+  Int64 bTotal = b[m + count] + bCarry;
+  if( count < m )
+    {
+    aTotal += a[count];
+    bTotal += b[count];
+    }
+
+  aSum[count] = aTotal & Integer::Int24BitMask;
+  bSum[count] = bTotal & Integer::Int24BitMask;
+  aCarry = aTotal >> 24;
+  bCarry = bTotal >> 24;
+  }
+
+aSum[h] = aCarry;
+bSum[h] = bCarry;
+
+const Int32 midSize = 2 * sumSize;
+Int64* middle = new Int64[midSize];
+karatsuba( aSum, bSum, sumSize, middle );
+
+// Take off a0 * b0 and a1 * b1.  This can't
+// go negative.
+Int64 borrow = 0;
+for( Int32 count = 0; count < midSize; count++ )
+  {
+  Int64 digit = middle[count] - borrow;
+  if( count < (2 * m) )
+    digit -= result[count];
+
+  if( count < (2 * h) )
+    digit -= result[(2 * m) + count];
+
+  borrow = 0;
+  while( digit < 0 )
+    {
+    digit += Integer::Int24BitMask + 1;
+    borrow++;
+    }
+
+  middle[count] = digit;
+  }
+
+if( borrow != 0 )
+  throw "HeapInt.karatsuba() borrow.";
+
+// Add the middle part in at m.
+Int64 carry = 0;
+const Int32 max = 2 * n;
+for( Int32 count = m; count < max; count++ )
+  {
+  Int64 total = result[count] + carry;
+  if( (count - m) < midSize )
+    total += middle[count - m];
+
+  result[count] = total & Integer::Int24BitMask;
+  carry = total >> 24;
+  }
+
+if( carry != 0 )
+  throw "HeapInt.karatsuba() carry.";
+
+delete[] middle;
+delete[] sums;
+}
+
+
+
+// result has aSize + bSize digits.  If one is
+// a lot longer than the other it is done in
+// pieces the size of the shorter one.
+
+void HeapInt::multiplyRaw( const Int64* a,
+                           const Int32 aSize,
+                           const Int64* b,
+                           const Int32 bSize,
+                           Int64* result )
+{
+if( aSize < bSize )
+  {
+  multiplyRaw( b, bSize, a, aSize, result );
+  return;
+  }
+
+if( bSize < KaratsubaThreshold )
+  {
+  multiplyBasic( a, aSize, b, bSize, result );
+  return;
+  }
+
+const Int32 max = aSize + bSize;
+for( Int32 count = 0; count < max; count++ )
+  result[count] = 0;
+
+Int64* piece = new Int64[bSize];
+Int64* product = new Int64[2 * bSize];
+
+for( Int32 where = 0; where < aSize;
+                               where += bSize )
+  {
+  Int32 pieceSize = aSize - where;
+  if( pieceSize > bSize )
+    pieceSize = bSize;
+
+  for( Int32 count = 0; count < bSize; count++ )
+    {
+    if( count < pieceSize )
+      piece[count] = a[where + count];
+    else
+      piece[count] = 0;
+
+    }
+
+  karatsuba( piece, b, bSize, product );
+
+  // The top of a padded piece is all zeros,
+  // so this only adds what fits.
+  Int64 carry = 0;
+  const Int32 top = pieceSize + bSize;
+  for( Int32 count = 0; count < top; count++ )
+    {
+    const Int64 total = result[where + count] +
+                        product[count] + carry;
+    result[where + count] = total &
+                        Integer::Int24BitMask;
+    carry = total >> 24;
+    }
+
+  if( carry != 0 )
+    throw "HeapInt.multiplyRaw() carry.";
+
+  }
+
+delete[] product;
+delete[] piece;
+}
+
+
+
+void HeapInt::multiply( const HeapInt& a,
+                        const HeapInt& b,
+                        HeapInt& result )
+{
+if( a.isZero() || b.isZero())
+  {
+  result.setToZero();
+  return;
+  }
+
+const Int32 aSize = a.index + 1;
+const Int32 bSize = b.index + 1;
+const Int32 size = aSize + bSize;
+
+// The result could be a or b, so it goes in
+// a new array first.
+Int64* product = new Int64[size];
+multiplyRaw( a.D, aSize, b.D, bSize, product );
+
+delete[] result.D;
+result.D = product;
+result.last = size;
+result.index = size - 1;
+result.trim();
+}
+
+
+
+bool HeapInt::paramIsGreater( const HeapInt& x )
+                                         const
+{
+if( x.index != index )
+  return x.index > index;
+
+for( Int32 count = index; count >= 0; count-- )
+  {
+  if( x.D[count] != D[count] )
+    return x.D[count] > D[count];
+
+  }
+
+return false;
+}
+
+
+
+void HeapInt::add( const HeapInt& toAdd )
+{
+Int32 max = index;
+if( max < toAdd.index )
+  {
+  const Int32 oldIndex = index;
+  setIndex( toAdd.index );
+  for( Int32 count = oldIndex + 1;
+                       count <= index; count++ )
+    D[count] = 0;
+
+  max = index;
+  }
+
+Int64 carry = 0;
+for( Int32 count = 0; count <= max; count++ )
+  {
+  Int64 total = D[count] + carry;
+  if( count <= toAdd.index )
+    total += toAdd.D[count];
+
+  D[count] = total & Integer::Int24BitMask;
+  carry = total >> 24;
+  }
+
+if( carry != 0 )
+  {
+  setIndex( max + 1 );
+  D[max + 1] = carry;
+  }
+}
+
+
+
+void HeapInt::subtract( const HeapInt& toSub )
+{
+if( paramIsGreater( toSub ))
+  throw "HeapInt.subtract() would be negative.";
+
+Int64 borrow = 0;
+for( Int32 count = 0; count <= index; count++ )
+  {
+  Int64 digit = D[count] - borrow;
+  if( count <= toSub.index )
+    digit -= toSub.D[count];
+
+  borrow = 0;
+  if( digit < 0 )
+    {
+    digit += Integer::Int24BitMask + 1;
+    borrow = 1;
+    }
+
+  D[count] = digit;
+  }
+
+trim();
+}
+
+
+
+void HeapInt::shiftDigitsLeft( const Int32 howMany )
+{
+if( howMany < 0 )
+  throw "HeapInt.shiftDigitsLeft() negative.";
+
+if( (howMany == 0) || isZero())
+  return;
+
+const Int32 oldIndex = index;
+setIndex( index + howMany );
+for( Int32 count = oldIndex; count >= 0; count-- )
+  D[count + howMany] = D[count];
+
+for( Int32 count = 0; count < howMany; count++ )
+  D[count] = 0;
+
+}
+
+
+
+void HeapInt::shiftDigitsRight( const Int32 howMany )
+{
+if( howMany < 0 )
+  throw "HeapInt.shiftDigitsRight() negative.";
+
+if( howMany == 0 )
+  return;
+
+if( howMany > index )
+  {
+  setToZero();
+  return;
+  }
+
+const Int32 max = index - howMany;
+for( Int32 count = 0; count <= max; count++ )
+  D[count] = D[count + howMany];
+
+index = max;
+}
+
+
+
+// This is Algorithm D on the heap arrays.
+// quotient can be nullptr.  remainder can be
+// the same object as toDivide, but quotient
+// can't be.
+
+void HeapInt::divideBasic( const HeapInt& toDivide,
+                           const HeapInt& divideBy,
+                           HeapInt* quotient,
+                           HeapInt& remainder )
+{
+if( divideBy.isZero())
+  throw "HeapInt.divideBasic() divide by zero.";
+
+const Int32 uSize = toDivide.index + 1;
+const Int32 vSize = divideBy.index + 1;
+
+if( uSize < vSize )
+  {
+  if( quotient != nullptr )
+    quotient->setToZero();
+
+  remainder.copy( toDivide );
+  return;
+  }
+
+if( vSize == 1 )
+  {
+  const Int64 divisor = divideBy.D[0];
+  if( quotient != nullptr )
+    quotient->setIndex( toDivide.index );
+
+  Int64 rem = 0;
+  for( Int32 count = toDivide.index; count >= 0;
+                                       count-- )
+    {
+    const Int64 twoDigits = (rem << 24) |
+                            toDivide.D[count];
+    if( quotient != nullptr )
+      quotient->D[count] = twoDigits / divisor;
+
+    rem = twoDigits % divisor;
+    }
+
+  if( quotient != nullptr )
+    quotient->trim();
+
+  remainder.setToZero();
+  remainder.D[0] = rem;
+  return;
+  }
+
+Int64* u = new Int64[uSize + 1];
+Int64* v = new Int64[vSize];
+Int64* q = nullptr;
+if( quotient != nullptr )
+  q = new Int64[uSize - vSize + 1];
+
+const Int32 shiftBy = Division::findShiftBy(
+                      divideBy.D[vSize - 1] );
+const Int32 shiftBack = 24 - shiftBy;
+
+Int64 carry = 0;
+for( Int32 count = 0; count < vSize; count++ )
+  {
+  const Int64 digit = divideBy.D[count];
+  v[count] = ((digit << shiftBy) &
+                  Integer::Int24BitMask) | carry;
+  carry = digit >> shiftBack;
+  }
+
+carry = 0;
+for( Int32 count = 0; count < uSize; count++ )
+  {
+  const Int64 digit = toDivide.D[count];
+  u[count] = ((digit << shiftBy) &
+                  Integer::Int24BitMask) | carry;
+  carry = digit >> shiftBack;
+  }
+
+u[uSize] = carry;
+
+Division::algorithmD( u, uSize, v, vSize, q );
+
+if( quotient != nullptr )
+  {
+  quotient->setIndex( uSize - vSize );
+  for( Int32 count = 0; count <= (uSize - vSize);
+                                       count++ )
+    quotient->D[count] = q[count];
+
+  quotient->trim();
+  }
+
+// Shift the remainder back.
+remainder.setIndex( vSize - 1 );
+carry = 0;
+for( Int32 count = vSize - 1; count >= 0;
+                                       count-- )
+  {
+  const Int64 digit = u[count];
+  remainder.D[count] = (digit >> shiftBy) |
+                                         carry;
+  carry = (digit << shiftBack) &
+                          Integer::Int24BitMask;
+  }
+
+remainder.trim();
+
+delete[] q;
+delete[] v;
+delete[] u;
+}
+
+
+
+void HeapInt::reciprocal( const HeapInt& divideBy,
+                          HeapInt& recip )
+{
+if( divideBy.isZero())
+  throw "HeapInt.reciprocal() divide by zero.";
+
+const Int32 k = divideBy.index + 1;
+
+// B^(2k)
+HeapInt power;
+power.setIndex( 2 * k );
+for( Int32 count = 0; count < (2 * k); count++ )
+  power.D[count] = 0;
+
+power.D[2 * k] = 1;
+
+HeapInt temp;
+if( k <= 40 )
+  {
+  divideBasic( power, divideBy, &recip, temp );
+  return;
+  }
+
+// The top h digits.  The three extra digits
+// make the one Newton step good to within a
+// few units, so the corrections at the end
+// are only a few steps.
+const Int32 h = (k / 2) + 3;
+HeapInt top;
+top.copy( divideBy );
+top.shiftDigitsRight( k - h );
+
+HeapInt approx;
+reciprocal( top, approx );
+approx.shiftDigitsLeft( k - h );
+
+// recip = (2 * approx) -
+//     ((divideBy * approx^2) / B^(2k))
+multiply( approx, approx, temp );
+multiply( temp, divideBy, temp );
+temp.shiftDigitsRight( 2 * k );
+recip.copy( approx );
+recip.add( approx );
+recip.subtract( temp );
+
+HeapInt one;
+one.D[0] = 1;
+
+// Make it exact.  product = divideBy * recip
+// has to be at most B^(2k) and within
+// divideBy of it.
+HeapInt product;
+multiply( divideBy, recip, product );
+while( power.paramIsGreater( product ))
+  {
+  recip.subtract( one );
+  product.subtract( divideBy );
+  }
+
+while( true )
+  {
+  temp.copy( power );
+  temp.subtract( product );
+  if( temp.paramIsGreater( divideBy ))
+    break;
+
+  recip.add( one );
+  product.add( divideBy );
+  }
+}
+
+
+
+// x has to be less than B^(2k), where
+// divideBy has k digits.  The quotient
+// estimate is never too big, and it is at
+// most two too small.
+
+void HeapInt::barrett( HeapInt& x,
+                       const HeapInt& divideBy,
+                       const HeapInt& recip,
+                       const Int32 k,
+                       HeapInt& temp )
+{
+if( x.index < (k - 1) )
+  return;
+
+multiply( x, recip, temp );
+temp.shiftDigitsRight( 2 * k );
+multiply( temp, divideBy, temp );
+x.subtract( temp );
+
+while( !x.paramIsGreater( divideBy ))
+  x.subtract( divideBy );
+
+}
+
+
+
+void HeapInt::remainder( const HeapInt& toDivide,
+                         const HeapInt& divideBy,
+                         HeapInt& remainder )
+{
+if( divideBy.isZero())
+  throw "HeapInt.remainder() divide by zero.";
+
+const Int32 uSize = toDivide.index + 1;
+const Int32 k = divideBy.index + 1;
+
+// Algorithm D costs about k times the size
+// of the quotient.
+if( (k < NewtonThreshold) ||
+    ((uSize - k) < (NewtonThreshold / 4)) )
+  {
+  divideBasic( toDivide, divideBy, nullptr,
+                                   remainder );
+  return;
+  }
+
+HeapInt recip;
+HeapInt temp;
+reciprocal( divideBy, recip );
+
+if( uSize <= (2 * k) )
+  {
+  remainder.copy( toDivide );
+  barrett( remainder, divideBy, recip, k, temp );
+  return;
+  }
+
+// Do it k digits at a time from the top, so
+// what is left is always less than B^(2k).
+HeapInt x;
+Int32 where = uSize;
+while( where > 0 )
+  {
+  Int32 take = k;
+  if( take > where )
+    take = where;
+
+  where -= take;
+  if( x.isZero())
+    x.setIndex( take - 1 );
+  else
+    x.shiftDigitsLeft( take );
+
+  for( Int32 count = 0; count < take; count++ )
+    x.D[count] = toDivide.D[where + count];
+
+  x.trim();
+  barrett( x, divideBy, recip, k, temp );
+  }
+
+remainder.copy( x );
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
@@ -0,0 +1,178 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// An Integer has a fixed array of
+// IntConst::DigitArraySize digits on the
+// stack.  The nodes at the top of a product
+// tree are far bigger than that, so this has
+// the same 24 bit digits in an array on the
+// heap that grows when it has to.  It only
+// does the few things the trees need, and it
+// is never negative.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+
+
+
+class HeapInt
+  {
+  private:
+  bool testForCopy = false;
+  Int64* D = nullptr;
+  Int32 last = 0; // How many are allocated.
+  Int32 index = 0;
+
+  // In digits.  Below this it is the
+  // schoolbook multiply.
+  static const Int32 KaratsubaThreshold = 64;
+
+  static void multiplyBasic( const Int64* a,
+                             const Int32 aSize,
+                             const Int64* b,
+                             const Int32 bSize,
+                             Int64* result );
+
+  static void karatsuba( const Int64* a,
+                         const Int64* b,
+                         const Int32 n,
+                         Int64* result );
+
+  static void multiplyRaw( const Int64* a,
+                           const Int32 aSize,
+                           const Int64* b,
+                           const Int32 bSize,
+                           Int64* result );
+
+  // In digits.  For a divisor this long or
+  // longer the remainder is done with a
+  // reciprocal instead of Algorithm D.
+  static const Int32 NewtonThreshold = 80;
+
+  static void divideBasic( const HeapInt& toDivide,
+                           const HeapInt& divideBy,
+                           HeapInt* quotient,
+                           HeapInt& remainder );
+
+  static void barrett( HeapInt& x,
+                       const HeapInt& divideBy,
+                       const HeapInt& recip,
+                       const Int32 k,
+                       HeapInt& temp );
+
+  public:
+  HeapInt( void )
+    {
+    setCapacity( 8 );
+    D[0] = 0;
+    }
+
+  HeapInt( const HeapInt& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "HeapInt copy constructor.";
+    }
+
+  ~HeapInt( void )
+    {
+    delete[] D;
+    }
+
+  // This keeps the digits it has.
+  void setCapacity( const Int32 howMany );
+
+  inline Int32 getIndex( void ) const
+    {
+    return index;
+    }
+
+  // The digits from index on up are not
+  // set to anything.
+  void setIndex( const Int32 setTo );
+
+  inline Int64 getD( const Int32 where ) const
+    {
+    if( (where < 0) || (where > index) )
+      throw "HeapInt.getD() range.";
+
+    return D[where];
+    }
+
+  inline void setD( const Int32 where,
+                    const Int64 toSet )
+    {
+    if( (where < 0) || (where > index) )
+      throw "HeapInt.setD() range.";
+
+    D[where] = toSet;
+    }
+
+  inline bool isZero( void ) const
+    {
+    return (index == 0) && (D[0] == 0);
+    }
+
+  inline void setToZero( void )
+    {
+    index = 0;
+    D[0] = 0;
+    }
+
+  // Bits, not counting leading zeros.
+  Int64 getBitLength( void ) const;
+
+  void trim( void );
+  void copy( const HeapInt& from );
+  void copyFromInteger( const Integer& from );
+
+  // This throws if it is too big for an
+  // Integer.
+  void copyToInteger( Integer& to ) const;
+
+  // result can be the same object as a or b.
+  static void multiply( const HeapInt& a,
+                        const HeapInt& b,
+                        HeapInt& result );
+
+  // paramIsGreater() is true if x is more
+  // than this, the same as for Integer.
+  bool paramIsGreater( const HeapInt& x ) const;
+  void add( const HeapInt& toAdd );
+
+  // This throws if toSub is more than this.
+  void subtract( const HeapInt& toSub );
+  void shiftDigitsLeft( const Int32 howMany );
+  void shiftDigitsRight( const Int32 howMany );
+
+  // recip = B^(2k) / divideBy, where divideBy
+  // has k digits and B is 2^24.  It is
+  // Newton's iteration, starting from the
+  // reciprocal of the top half of the
+  // digits, so it costs about as much as a
+  // few multiplies.
+  static void reciprocal( const HeapInt& divideBy,
+                          HeapInt& recip );
+
+  // It uses Division::algorithmD(), or
+  // Barrett's reduction with reciprocal()
+  // when divideBy is big.  remainder can be
+  // the same object as toDivide.
+  static void remainder( const HeapInt& toDivide,
+                         const HeapInt& divideBy,
+                         HeapInt& remainder );
+
+  };
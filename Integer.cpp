@@ -653,6 +653,32 @@ index = index + howMany;
 
 
 
+// This drops the bottom digits.  It's dividing
+// by 2^24 howMany times.
+void Integer::shiftDigitsRight(
+                       const Int32 howMany )
+{
+if( howMany == 0 )
+  return;
+
+if( howMany < 0 )
+  throw "Integer.shiftDigitsRight negative.";
+
+if( howMany > index )
+  {
+  setToZero();
+  return;
+  }
+
+const Int32 max = index - howMany;
+for( Int32 count = 0; count <= max; count++ )
+  dArray[count] = dArray[count + howMany];
+
+index = max;
+}
+
+
+
 void Integer::shiftRight( const Int32 shiftBy )
 {
 if( shiftBy > 24 )
@@ -256,6 +256,7 @@ class Integer
   void add( const Integer& toAdd );
   void shiftLeft( const Int32 shiftBy );
   void shiftDigitsLeft( const Int32 howMany );
+  void shiftDigitsRight( const Int32 howMany );
   void shiftRight( const Int32 shiftBy );
   bool makeRandomOdd( const Int32 setToIndex );
   void borrow( void );
@@ -15,6 +15,12 @@
 #include "../CppBase/ByteHex.h"
 #include "Base10Number.h"
 #include "Division.h"
+#include "ProductTree.h"
+#include "LehmerGcd.h"
+
+
+
+#include "../CppMem/MemoryWarnTop.h"
 
 
 
@@ -86,13 +92,45 @@ if( (toTest.getD( 0 ) & 1) == 0 )
 // Don't make this smaller than primesArraySize.
 // Primality testing and other things depend
 // on it.
+
+if( toTest.getIndex() >= screenMinIndex )
+  {
+  if( !primorialScreen.isSetUp())
+    primorialScreen.setup( sPrimes );
+
+  return primorialScreen.
+                 isDivisibleBySmallPrime( toTest );
+  }
+
+if( primeRecips == nullptr )
+  setupPrimeRecips( sPrimes );
+
+// The primes are done modLanes at a time, so
+// it goes through the digits of toTest once
+// for each group instead of once for each
+// prime.
+Int64 remainders[modLanes];
+
 for( Int32 count = 1; count <
-             SPrimes::primesArraySize; count++ )
+           SPrimes::primesArraySize;
+                         count += modLanes )
   {
-  Int32 prime = sPrimes.getPrimeAt( count );
-  if( 0 == getMod24( toTest, prime ))
-    return prime;
+  Int32 howMany = SPrimes::primesArraySize -
+                                      count;
+  if( howMany > modLanes )
+    howMany = modLanes;
 
+  const Recip24* recips = &primeRecips[
+                                   count - 1];
+  getMod24Lanes( toTest, recips, remainders );
+
+  for( Int32 lane = 0; lane < howMany; lane++ )
+    {
+    if( remainders[lane] == 0 )
+      return Casting::i64ToI32(
+                   recips[lane].getDivisor());
+
+    }
   }
 
 // StIO::putS( "Bottom of isDivisible." );
@@ -103,6 +141,198 @@ return 0;
 
 
 
+void IntegerMath::setHeapIntFrom48( HeapInt& toSet,
+                                    const Int64 from )
+{
+toSet.setIndex( 1 );
+toSet.setD( 0, from & Integer::Int24BitMask );
+toSet.setD( 1, from >> 24 );
+toSet.trim();
+}
+
+
+
+void IntegerMath::setupBatchPrimorial(
+                         const Int32 primeBound )
+{
+if( (primeBound < 3) || (primeBound > 0x4000000) )
+  throw "setupBatchPrimorial() primeBound range.";
+
+// Sieve of Eratosthenes.
+char* isComposite = new char[primeBound];
+for( Int32 count = 0; count < primeBound; count++ )
+  isComposite[count] = 0;
+
+for( Int32 count = 2; (count * count) < primeBound;
+                                      count++ )
+  {
+  if( isComposite[count] != 0 )
+    continue;
+
+  for( Int32 mult = count * count;
+         mult < primeBound; mult += count )
+    isComposite[mult] = 1;
+
+  }
+
+// The leaves are products of consecutive
+// primes that fit in 48 bits, so there are
+// fewer of them.  An Integer is too big to
+// have this many of, so it doesn't use a
+// ProductTree.
+Int32 primeCount = 0;
+for( Int32 count = 2; count < primeBound; count++ )
+  {
+  if( isComposite[count] == 0 )
+    primeCount++;
+
+  }
+
+Int32 leafCount = 0;
+HeapInt* nodes = new HeapInt[primeCount];
+Int64 prod = 1;
+for( Int32 count = 2; count < primeBound; count++ )
+  {
+  if( isComposite[count] != 0 )
+    continue;
+
+  if( prod > (Integer::Int48BitMask / count) )
+    {
+    setHeapIntFrom48( nodes[leafCount], prod );
+    leafCount++;
+    prod = 1;
+    }
+
+  prod *= count;
+  }
+
+setHeapIntFrom48( nodes[leafCount], prod );
+leafCount++;
+
+// Each pair goes up to the next level in
+// the same array.
+while( leafCount > 1 )
+  {
+  const Int32 size = (leafCount + 1) / 2;
+  for( Int32 count = 0; count < size; count++ )
+    {
+    const Int32 left = count * 2;
+    if( (left + 1) < leafCount )
+      HeapInt::multiply( nodes[left],
+                         nodes[left + 1],
+                         nodes[count] );
+    else
+      nodes[count].copy( nodes[left] );
+
+    }
+
+  leafCount = size;
+  }
+
+batchPrimorial.copy( nodes[0] );
+batchPrimeBound = primeBound;
+
+delete[] nodes;
+delete[] isComposite;
+}
+
+
+
+Int32 IntegerMath::isDivisibleBySmallPrimeBatch(
+                         const Integer* toTest,
+                         const Int32 howMany,
+                         const Int32 primeBound,
+                         Integer* gcds )
+{
+if( howMany < 1 )
+  return 0;
+
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  if( toTest[count].getNegative() ||
+      toTest[count].isZero())
+    throw "isDivisibleBySmallPrimeBatch() not positive.";
+
+  }
+
+if( batchPrimeBound != primeBound )
+  setupBatchPrimorial( primeBound );
+
+// A tree over all of them at once would
+// have nodes far bigger than the primorial
+// at the top, and those multiplies cost more
+// than doing the primorial mod the top of
+// each group.
+HeapInt* remainders = new HeapInt[howMany];
+Int32 start = 0;
+while( start < howMany )
+  {
+  Int32 digits = toTest[start].getIndex() + 1;
+  Int32 end = start + 1;
+  while( end < howMany )
+    {
+    digits += toTest[end].getIndex() + 1;
+    if( digits > batchGroupDigits )
+      break;
+
+    end++;
+    }
+
+  ProductTree tree;
+  tree.build( &toTest[start], end - start );
+  tree.remainderTree( batchPrimorial, false,
+                      &remainders[start] );
+  start = end;
+  }
+
+Int32 found = 0;
+Integer rem;
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  remainders[count].copyToInteger( rem );
+  if( rem.isZero())
+    gcds[count].copy( toTest[count] );
+  else
+    LehmerGcd::gcd( rem, toTest[count],
+                    gcds[count], *this );
+
+  if( !gcds[count].isOne())
+    found++;
+
+  }
+
+delete[] remainders;
+return found;
+}
+
+
+
+void IntegerMath::setupPrimeRecips(
+                        const SPrimes& sPrimes )
+{
+// Starting at 1 since 2 is at index 0.
+const Int32 howMany = SPrimes::primesArraySize
+                                         - 1;
+primeRecipsSize = ((howMany + modLanes - 1) /
+                           modLanes) * modLanes;
+
+Recip24* recips = new Recip24[primeRecipsSize];
+for( Int32 count = 0; count < primeRecipsSize;
+                                      count++ )
+  {
+  Int32 where = count + 1;
+  if( count >= howMany )
+    where = 1;
+
+  recips[count].setDivisor(
+                  sPrimes.getPrimeAt( where ));
+  }
+
+primeRecips = recips;
+}
+
+
+
 
 void IntegerMath::add( Integer& result,
                        const Integer& toAdd )
@@ -167,7 +397,7 @@ if( result.getNegative() &&
   else
     {
     add1.subtract( add2 );
-    result.copy( add2 );
+    result.copy( add1 );
     result.setNegative( true );
     return;
     }
@@ -347,10 +577,14 @@ if( B1 == 0 )
   return;
   }
 
+// Integer::add() wants positive numbers, so
+// the sign gets put back at the end.
+const bool isNeg = result.getNegative();
 Integer row1;
 Integer row2;
 row1.copy( result );
-row2.copy( result );
+row1.setNegative( false );
+row2.copy( row1 );
 
 row1.multiply24( B0 );
 row2.multiply24( B1 );
@@ -358,6 +592,7 @@ row2.shiftDigitsLeft( 1 );
 row2.add( row1 );
 
 result.copy( row2 );
+result.setNegative( isNeg );
 }
 
 
@@ -407,8 +642,11 @@ if( toMul.isLong48())
 
 // StIO::putS( "Full multiply." );
 
+// The rows get added with Integer::add(), so
+// they have to be positive.
 Integer resultConst;
 resultConst.copy( result );
+resultConst.setNegative( false );
 
 const Int32 totalIndex = resultConst.getIndex() +
                          toMul.getIndex();
@@ -432,8 +670,9 @@ for( Int32 row = 0; row <= max; row++ )
 // result, and possibly toMul, is not changed
 // until this point.
 
+const bool isNeg = result.getNegative();
 result.copy( accum );
-result.setNegative( resultConst.getNegative());
+result.setNegative( isNeg );
 setMultiplySign( result, toMul );
 }
 
@@ -525,16 +764,33 @@ if( from.isLong48())
 Integer toDivide;
 toDivide.copy( from );
 
-Integer quotient;
+// Seven decimal digits at a time, since
+// 10^7 fits in 24 bits.  Then it is one
+// pass through the digits for every seven
+// decimal digits, not for each one.
+const Int64 tenToSeven = 10000000;
+Recip24 recip;
+recip.setDivisor( tenToSeven );
+
 CharBuf cBuf;
 while( !toDivide.isZero())
   {
-  Int32 digit = Casting::i64ToI32( Division::
-       shortDivideRem( toDivide, 10, quotient ));
-  toDivide.copy( quotient );
-  // Ascii values go from '0' up to '9'.
-  cBuf.appendChar( Casting::i32ToChar(
-                          '0' + digit ));
+  Int64 chunk = recip.divide( toDivide,
+                              toDivide );
+  const bool isTop = toDivide.isZero();
+  for( Int32 count = 0; count < 7; count++ )
+    {
+    if( isTop && (chunk == 0) )
+      break;
+
+    Int32 digit = Casting::i64ToI32(
+                                  chunk % 10 );
+    chunk = chunk / 10;
+
+    // Ascii values go from '0' up to '9'.
+    cBuf.appendChar( Casting::i32ToChar(
+                            '0' + digit ));
+    }
   }
 
 if( from.getNegative() )
@@ -1048,9 +1304,51 @@ if( in.getIndex() == 0 )
   return result;
   }
 
-Integer temp;
-temp.copy( in );
-return temp.getModDestruct( divisor );
+// This is what getModDestruct() does, but
+// only the remainder is kept, so nothing
+// has to be copied or changed.  Setting up
+// the reciprocal is the only real division.
+Recip24 recip;
+recip.setDivisor( divisor );
+return Casting::i64ToI32( recip.getMod( in ));
+}
+
+
+
+// This finds the remainders for modLanes
+// divisors in one pass through the digits.
+// Each digit gets read once, and the lanes
+// don't depend on each other, so the
+// divisions can overlap in the pipeline.
+
+void IntegerMath::getMod24Lanes(
+                        const Integer& in,
+                        const Recip24* recips,
+                        Int64* remainders )
+{
+// These stay shifted like in Recip24.
+for( Int32 lane = 0; lane < modLanes; lane++ )
+  {
+  if( recips[lane].getDivisor() == 0 )
+    throw "IntegerMath.getMod24Lanes divisor.";
+
+  remainders[lane] = 0;
+  }
+
+for( Int32 count = in.getIndex(); count >= 0;
+                                       count-- )
+  {
+  const Int64 digit = in.getD( count );
+  for( Int32 lane = 0; lane < modLanes; lane++ )
+    recips[lane].nextDigit( digit,
+                            remainders[lane] );
+
+  }
+
+for( Int32 lane = 0; lane < modLanes; lane++ )
+  remainders[lane] = recips[lane].unShift(
+                            remainders[lane] );
+
 }
 
 
@@ -1189,3 +1487,7 @@ while( true )
 
 
 */
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
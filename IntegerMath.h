@@ -17,6 +17,9 @@
 // #include "../CppBase/FileIO.h"
 #include "../CppBase/CharBuf.h"
 #include "Integer.h"
+#include "Recip24.h"
+#include "PrimorialScreen.h"
+#include "HeapInt.h"
 #include "../CryptoBase/SPrimes.h"
 
 
@@ -26,6 +29,31 @@ class IntegerMath
   private:
   bool testForCopy = false;
 
+  // A reciprocal for each prime in SPrimes,
+  // made the first time it is needed.
+  // It is padded with copies of the first
+  // prime so it is a multiple of modLanes.
+  Recip24* primeRecips = nullptr;
+  Int32 primeRecipsSize = 0;
+
+  void setupPrimeRecips( const SPrimes& sPrimes );
+
+  // For bigger numbers the primes are screened
+  // in blocks first.  At this size it gets to
+  // be faster than doing each prime.
+  static const Int32 screenMinIndex = 32;
+  PrimorialScreen primorialScreen;
+
+  // The product of the primes less than
+  // batchPrimeBound, for the batch version.
+  // It is made again if the bound changes.
+  HeapInt batchPrimorial;
+  Int32 batchPrimeBound = 0;
+  static const Int32 batchGroupDigits = 2048;
+
+  static void setHeapIntFrom48( HeapInt& toSet,
+                                const Int64 from );
+  void setupBatchPrimorial( const Int32 primeBound );
 
   void setMultiplySign( Integer& result,
                         const Integer& toMul );
@@ -48,8 +76,14 @@ class IntegerMath
     throw "Copy constructor: IntegerMath.";
     }
 
+  // It owns primeRecips, so a copy would
+  // delete it twice.
+  IntegerMath& operator=(
+                   const IntegerMath& in ) = delete;
+
   ~IntegerMath( void )
     {
+    delete[] primeRecips;
     }
 
 
@@ -60,6 +94,27 @@ class IntegerMath
                         const Integer& toTest,
                         const SPrimes& sPrimes );
 
+  // This is for trial division of a lot of
+  // numbers at once, with far more primes
+  // than SPrimes has.  Each gcds[count] gets
+  // the gcd of toTest[count] and the product
+  // of all of the primes less than
+  // primeBound, so it is 1 if none of them
+  // divide it.  The numbers go in product
+  // trees and the remainder trees take the
+  // primorial mod each of them, so it goes
+  // through the primes once for all of them
+  // instead of once for each one.  For just
+  // the primes in SPrimes
+  // isDivisibleBySmallPrime() is faster.
+  // They have to be positive.  It returns
+  // how many gcds are not 1.
+  Int32 isDivisibleBySmallPrimeBatch(
+                        const Integer* toTest,
+                        const Int32 howMany,
+                        const Int32 primeBound,
+                        Integer* gcds );
+
   void add( Integer& result,
                       const Integer& toAdd );
 
@@ -90,6 +145,14 @@ class IntegerMath
   Int32 getMod24( const Integer& in,
                   const Int64 divisor );
 
+  // How many divisors getMod24Lanes() does
+  // in one pass.
+  static const Int32 modLanes = 8;
+
+  static void getMod24Lanes( const Integer& in,
+                             const Recip24* recips,
+                             Int64* remainders );
+
 /*
   Int64 getMod48( const Integer& in,
                   const Int64 divisor );
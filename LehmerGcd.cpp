@@ -0,0 +1,599 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "LehmerGcd.h"
+#include "Division.h"
+
+
+
+Int64 LehmerGcd::getDigit( const Integer& x,
+                           const Int32 where )
+{
+if( where > x.getIndex())
+  return 0;
+
+return x.getD( where );
+}
+
+
+
+Int32 LehmerGcd::getBitLength( const Integer& x )
+{
+Int64 top = x.getD( x.getIndex());
+Int32 bits = 0;
+while( top != 0 )
+  {
+  top >>= 1;
+  bits++;
+  }
+
+return (x.getIndex() * 24) + bits;
+}
+
+
+
+// x shifted right by shiftBy.  That has to
+// fit in 48 bits.
+
+Int64 LehmerGcd::getTop48( const Integer& x,
+                           const Int32 shiftBy )
+{
+const Int32 where = shiftBy / 24;
+const Int32 bits = shiftBy % 24;
+
+Int64 result = getDigit( x, where + 2 ) <<
+                                 (48 - bits);
+result |= getDigit( x, where + 1 ) <<
+                                 (24 - bits);
+result |= getDigit( x, where ) >> bits;
+return result;
+}
+
+
+
+// This multiplies by a positive word of up
+// to 63 bits in one pass, and keeps the sign
+// of x.
+
+void LehmerGcd::multiplyWord( Integer& x,
+                              const Int64 word )
+{
+if( word < 0 )
+  throw "LehmerGcd.multiplyWord() negative.";
+
+if( (word == 0) || x.isZero())
+  {
+  x.setToZero();
+  return;
+  }
+
+const Int64 mask = Integer::Int24BitMask;
+const Int64 w0 = word & mask;
+const Int64 w1 = (word >> 24) & mask;
+const Int64 w2 = word >> 48;
+
+const Int32 max = x.getIndex();
+if( (max + 4) >= IntConst::DigitArraySize )
+  throw "LehmerGcd.multiplyWord() too big.";
+
+Int64 prev1 = 0; // The digit at count - 1.
+Int64 prev2 = 0; // The digit at count - 2.
+Int64 carry = 0;
+Int32 count = 0;
+for( ; count <= (max + 2); count++ )
+  {
+  Int64 digit = 0;
+  if( count <= max )
+    digit = x.getD( count );
+
+  const Int64 sum = (digit * w0) + (prev1 * w1) +
+                               (prev2 * w2) + carry;
+  x.setD( count, sum & mask );
+  carry = sum >> 24;
+  prev2 = prev1;
+  prev1 = digit;
+  }
+
+while( carry != 0 )
+  {
+  x.setD( count, carry & mask );
+  carry >>= 24;
+  count++;
+  }
+
+Int32 top = count - 1;
+while( (top > 0) && (x.getD( top ) == 0) )
+  top--;
+
+x.setIndex( top );
+}
+
+
+
+// result = (p * x) + (q * y) with signs.
+
+void LehmerGcd::combine( Integer& result,
+                         const Int64 p,
+                         const Integer& x,
+                         const Int64 q,
+                         const Integer& y,
+                         IntegerMath& intMath )
+{
+Integer second;
+result.copy( x );
+if( p < 0 )
+  {
+  multiplyWord( result, -p );
+  if( !result.isZero())
+    result.setNegative( !result.getNegative());
+
+  }
+else
+  {
+  multiplyWord( result, p );
+  }
+
+second.copy( y );
+if( q < 0 )
+  {
+  multiplyWord( second, -q );
+  if( !second.isZero())
+    second.setNegative( !second.getNegative());
+
+  }
+else
+  {
+  multiplyWord( second, q );
+  }
+
+intMath.add( result, second );
+}
+
+
+
+// The Euclid steps on the top 48 bits.
+// matrix is A, B, C, D, so that the new a is
+// (A * a) + (B * b) and the new b is
+// (C * a) + (D * b).  Knuth checks each
+// quotient with both ends of the range that
+// the true numbers could be in, so every
+// step is a step the full numbers would
+// make too.  It returns false if it couldn't
+// do any steps.
+
+bool LehmerGcd::lehmerMatrix( const Integer& a,
+                              const Integer& b,
+                              Int64* matrix )
+{
+const Int32 shiftBy = getBitLength( a ) - 48;
+Int64 aHat = getTop48( a, shiftBy );
+Int64 bHat = getTop48( b, shiftBy );
+
+Int64 A = 1;
+Int64 B = 0;
+Int64 C = 0;
+Int64 D = 1;
+while( true )
+  {
+  const Int64 denom1 = bHat + C;
+  const Int64 denom2 = bHat + D;
+  if( (denom1 <= 0) || (denom2 <= 0) )
+    break;
+
+  const Int64 q = (aHat + A) / denom1;
+  if( q != ((aHat + B) / denom2) )
+    break;
+
+  Int64 temp = A - (q * C);
+  A = C;
+  C = temp;
+
+  temp = B - (q * D);
+  B = D;
+  D = temp;
+
+  temp = aHat - (q * bHat);
+  aHat = bHat;
+  bHat = temp;
+  }
+
+matrix[0] = A;
+matrix[1] = B;
+matrix[2] = C;
+matrix[3] = D;
+return B != 0;
+}
+
+
+
+Int64 LehmerGcd::binaryGcd( Int64 x, Int64 y )
+{
+if( x == 0 )
+  return y;
+
+if( y == 0 )
+  return x;
+
+Int32 shift = 0;
+while( ((x | y) & 1) == 0 )
+  {
+  x >>= 1;
+  y >>= 1;
+  shift++;
+  }
+
+while( (x & 1) == 0 )
+  x >>= 1;
+
+while( y != 0 )
+  {
+  while( (y & 1) == 0 )
+    y >>= 1;
+
+  if( x > y )
+    {
+    Int64 temp = x;
+    x = y;
+    y = temp;
+    }
+
+  y -= x;
+  }
+
+return x << shift;
+}
+
+
+
+Int64 LehmerGcd::binaryExtGcd( Int64 x,
+                               Int64 y,
+                               Int64& u,
+                               Int64& v )
+{
+if( (x < 0) || (y < 0) ||
+    ((x >> 48) != 0) || ((y >> 48) != 0) )
+  throw "LehmerGcd.binaryExtGcd() range.";
+
+if( y == 0 )
+  {
+  u = 1;
+  v = 0;
+  return x;
+  }
+
+if( x == 0 )
+  {
+  u = 0;
+  v = 1;
+  return y;
+  }
+
+Int32 shift = 0;
+while( ((x | y) & 1) == 0 )
+  {
+  x >>= 1;
+  y >>= 1;
+  shift++;
+  }
+
+// (A * x) + (B * y) = uu and
+// (C * x) + (D * y) = vv the whole time.
+Int64 uu = x;
+Int64 vv = y;
+Int64 A = 1;
+Int64 B = 0;
+Int64 C = 0;
+Int64 D = 1;
+while( true )
+  {
+  while( (uu & 1) == 0 )
+    {
+    uu >>= 1;
+    if( ((A | B) & 1) == 0 )
+      {
+      A /= 2;
+      B /= 2;
+      }
+    else
+      {
+      A = (A + y) / 2;
+      B = (B - x) / 2;
+      }
+    }
+
+  while( (vv & 1) == 0 )
+    {
+    vv >>= 1;
+    if( ((C | D) & 1) == 0 )
+      {
+      C /= 2;
+      D /= 2;
+      }
+    else
+      {
+      C = (C + y) / 2;
+      D = (D - x) / 2;
+      }
+    }
+
+  if( uu >= vv )
+    {
+    uu -= vv;
+    A -= C;
+    B -= D;
+    }
+  else
+    {
+    vv -= uu;
+    C -= A;
+    D -= B;
+    }
+
+  if( uu == 0 )
+    break;
+
+  }
+
+u = C;
+v = D;
+return vv << shift;
+}
+
+
+
+// If cofactor isn't nullptr it gets u so
+// that gcd = (u * x) + (something * y).
+// y has to be more than zero and
+// x less than y.  cofactor is for x and
+// yCofactor is for y, so
+// gcd = (cofactor * x) + (yCofactor * y).
+// Either one can be null.
+
+void LehmerGcd::run( const Integer& x,
+                     const Integer& y,
+                     Integer& gcd,
+                     Integer* cofactor,
+                     Integer* yCofactor,
+                     IntegerMath& intMath )
+{
+// a = (sA * y) + (tA * x)
+// b = (sB * y) + (tB * x)
+Integer a;
+Integer b;
+Integer tA;
+Integer tB;
+Integer sA;
+Integer sB;
+Integer newA;
+Integer newB;
+Integer quotient;
+Integer remainder;
+a.copy( y );
+b.copy( x );
+tA.setToZero();
+tB.setToOne();
+sA.setToOne();
+sB.setToZero();
+
+Int64 matrix[4];
+while( true )
+  {
+  if( b.isZero())
+    {
+    gcd.copy( a );
+    if( cofactor != nullptr )
+      cofactor->copy( tA );
+
+    if( yCofactor != nullptr )
+      yCofactor->copy( sA );
+
+    return;
+    }
+
+  if( a.isLong48())
+    {
+    Int64 u = 0;
+    Int64 v = 0;
+    const Int64 g = binaryExtGcd(
+                          a.getAsLong48(),
+                          b.getAsLong48(), u, v );
+    gcd.setFromLong48( g );
+    if( cofactor != nullptr )
+      combine( *cofactor, u, tA, v, tB,
+                                   intMath );
+
+    if( yCofactor != nullptr )
+      combine( *yCofactor, u, sA, v, sB,
+                                   intMath );
+
+    return;
+    }
+
+  if( lehmerMatrix( a, b, matrix ))
+    {
+    combine( newA, matrix[0], a, matrix[1], b,
+                                     intMath );
+    combine( newB, matrix[2], a, matrix[3], b,
+                                     intMath );
+    a.copy( newA );
+    b.copy( newB );
+
+    if( cofactor != nullptr )
+      {
+      combine( newA, matrix[0], tA, matrix[1],
+                                tB, intMath );
+      combine( newB, matrix[2], tA, matrix[3],
+                                tB, intMath );
+      tA.copy( newA );
+      tB.copy( newB );
+      }
+
+    if( yCofactor != nullptr )
+      {
+      combine( newA, matrix[0], sA, matrix[1],
+                                sB, intMath );
+      combine( newB, matrix[2], sA, matrix[3],
+                                sB, intMath );
+      sA.copy( newA );
+      sB.copy( newB );
+      }
+
+    continue;
+    }
+
+  // The quotient was too big for the top
+  // 48 bits, so do a full division step.
+  Division::divide( a, b, quotient, remainder,
+                                     intMath );
+  a.copy( b );
+  b.copy( remainder );
+  if( cofactor != nullptr )
+    {
+    newB.copy( quotient );
+    intMath.multiply( newB, tB );
+    newA.copy( tA );
+    intMath.subtract( newA, newB );
+    tA.copy( tB );
+    tB.copy( newA );
+    }
+
+  if( yCofactor != nullptr )
+    {
+    newB.copy( quotient );
+    intMath.multiply( newB, sB );
+    newA.copy( sA );
+    intMath.subtract( newA, newB );
+    sA.copy( sB );
+    sB.copy( newA );
+    }
+  }
+}
+
+
+
+void LehmerGcd::gcd( const Integer& x,
+                     const Integer& y,
+                     Integer& gcd,
+                     IntegerMath& intMath )
+{
+if( x.getNegative() || y.getNegative())
+  throw "LehmerGcd.gcd() negative.";
+
+if( x.isZero())
+  {
+  gcd.copy( y );
+  return;
+  }
+
+if( y.isZero())
+  {
+  gcd.copy( x );
+  return;
+  }
+
+if( x.isLong48() && y.isLong48())
+  {
+  gcd.setFromLong48( binaryGcd( x.getAsLong48(),
+                                y.getAsLong48()));
+  return;
+  }
+
+if( y.paramIsGreater( x ))
+  run( y, x, gcd, nullptr, nullptr,
+                              intMath );
+else
+  run( x, y, gcd, nullptr, nullptr,
+                              intMath );
+
+}
+
+
+
+void LehmerGcd::extendedGcd( const Integer& x,
+                             const Integer& y,
+                             Integer& gcd,
+                             Integer& u,
+                             Integer& v,
+                             IntegerMath& intMath )
+{
+if( x.getNegative() || y.getNegative())
+  throw "LehmerGcd.extendedGcd() negative.";
+
+if( y.isZero())
+  {
+  gcd.copy( x );
+  u.setToOne();
+  v.setToZero();
+  return;
+  }
+
+if( x.isZero())
+  {
+  gcd.copy( y );
+  u.setToZero();
+  v.setToOne();
+  return;
+  }
+
+// run() wants the smaller one first.
+if( x.paramIsGreater( y ))
+  run( x, y, gcd, &u, &v, intMath );
+else
+  run( y, x, gcd, &v, &u, intMath );
+
+}
+
+
+
+bool LehmerGcd::multInverse( const Integer& x,
+                             const Integer& modulus,
+                             Integer& inverse,
+                             Integer& gcd,
+                             IntegerMath& intMath )
+{
+if( x.getNegative() || modulus.getNegative() ||
+    modulus.isZero())
+  throw "LehmerGcd.multInverse() bad values.";
+
+Integer reduced;
+reduced.copy( x );
+if( modulus.paramIsGreaterOrEq( reduced ))
+  Division::remainderOnly( reduced, modulus,
+                           reduced, intMath );
+
+if( reduced.isZero())
+  {
+  gcd.copy( modulus );
+  return false;
+  }
+
+Integer cofactor;
+run( reduced, modulus, gcd, &cofactor,
+                      nullptr, intMath );
+if( !gcd.isOne())
+  return false;
+
+// The cofactor could be negative and it
+// could be more than the modulus.
+const bool isNeg = cofactor.getNegative();
+cofactor.setNegative( false );
+Division::remainderOnly( cofactor, modulus,
+                         cofactor, intMath );
+if( isNeg && !cofactor.isZero())
+  {
+  inverse.copy( modulus );
+  intMath.subtract( inverse, cofactor );
+  return true;
+  }
+
+inverse.copy( cofactor );
+return true;
+}
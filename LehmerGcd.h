@@ -0,0 +1,101 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// Lehmer's gcd, the way it is in Knuth,
+// Algorithm L in section 4.5.2 of The Art of
+// Computer Programming, Volume 2.
+// The Euclid steps are done on the top 48
+// bits of the two numbers with Int64 math.
+// Those steps make a 2 by 2 matrix, and then
+// the matrix is used on the big numbers all
+// at once.  So there is one pass through the
+// digits for a lot of quotients, instead of
+// one whole division for each quotient.
+
+// Once the numbers fit in 48 bits it is
+// finished with the binary (Stein) extended
+// gcd on Int64 values.  See Algorithm 14.61
+// in the Handbook of Applied Cryptography.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+
+
+class LehmerGcd
+  {
+  private:
+  static Int64 getDigit( const Integer& x,
+                         const Int32 where );
+
+  static bool lehmerMatrix( const Integer& a,
+                            const Integer& b,
+                            Int64* matrix );
+
+  static void run( const Integer& x,
+                   const Integer& y,
+                   Integer& gcd,
+                   Integer* cofactor,
+                   Integer* yCofactor,
+                   IntegerMath& intMath );
+
+  public:
+  // HalfGcd uses these too.
+  static Int64 getTop48( const Integer& x,
+                         const Int32 shiftBy );
+
+  static Int32 getBitLength( const Integer& x );
+
+  static void multiplyWord( Integer& x,
+                            const Int64 word );
+
+  static void combine( Integer& result,
+                       const Int64 p,
+                       const Integer& x,
+                       const Int64 q,
+                       const Integer& y,
+                       IntegerMath& intMath );
+
+  // gcd = (u * x) + (v * y) and u and v
+  // are for x and y both less than 2^48.
+  static Int64 binaryExtGcd( Int64 x,
+                             Int64 y,
+                             Int64& u,
+                             Int64& v );
+
+  static Int64 binaryGcd( Int64 x, Int64 y );
+
+  static void gcd( const Integer& x,
+                   const Integer& y,
+                   Integer& gcd,
+                   IntegerMath& intMath );
+
+  // gcd = (u * x) + (v * y), where u and v
+  // can be negative.
+  static void extendedGcd( const Integer& x,
+                           const Integer& y,
+                           Integer& gcd,
+                           Integer& u,
+                           Integer& v,
+                           IntegerMath& intMath );
+
+  // The same as Euclid::multInverse().
+  static bool multInverse( const Integer& x,
+                           const Integer& modulus,
+                           Integer& inverse,
+                           Integer& gcd,
+                           IntegerMath& intMath );
+
+  };
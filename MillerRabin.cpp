@@ -0,0 +1,239 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "MillerRabin.h"
+
+#include <chrono>
+
+
+
+MillerRabin::MillerRabin( void )
+{
+// 3,317,044,064,679,887,385,961,981
+deterministicLimit.setToZero();
+deterministicLimit.setIndex( 3 );
+deterministicLimit.setD( 0, 0x10a5fd );
+deterministicLimit.setD( 1, 0xc5b224 );
+deterministicLimit.setD( 2, 0x6951ad );
+deterministicLimit.setD( 3, 0x2be );
+}
+
+
+
+void MillerRabin::clearStats( void )
+{
+lastRounds = 0;
+lastMicroSeconds = 0;
+totalTests = 0;
+totalRounds = 0;
+totalMicroSeconds = 0;
+}
+
+
+
+bool MillerRabin::isLessThan2To64(
+                            const Integer& n )
+{
+if( n.getIndex() < 2 )
+  return true;
+
+if( n.getIndex() > 2 )
+  return false;
+
+// 48 bits plus 16 bits in the top digit.
+return (n.getD( 2 ) >> 16) == 0;
+}
+
+
+
+// n - 1 = oddPart * 2^twoPower.
+
+void MillerRabin::setupOddPart( const Integer& n )
+{
+nMinus1.copy( n );
+nMinus1.decrement();
+
+oddPart.copy( nMinus1 );
+twoPower = 0;
+while( (oddPart.getD( 0 ) & 1) == 0 )
+  {
+  oddPart.shiftRight( 1 );
+  twoPower++;
+  }
+}
+
+
+
+bool MillerRabin::isStrongProbable(
+                          const Integer& n,
+                          const Integer& base,
+                          IntegerMath& intMath )
+{
+x.copy( base );
+if( n.paramIsGreaterOrEq( x ))
+  mod.makeExact( x, n, intMath );
+
+if( x.isZero() || x.isOne() ||
+    x.isEqual( nMinus1 ))
+  return true; // Nothing to learn from it.
+
+// This uses the same mod for every base.
+mod.toPower( x, oddPart, n, intMath );
+
+if( x.isOne() || x.isEqual( nMinus1 ))
+  return true;
+
+for( Int32 count = 1; count < twoPower;
+                                      count++ )
+  {
+  temp.copy( x );
+  mod.multiply( x, temp, n, intMath );
+
+  if( x.isEqual( nMinus1 ))
+    return true;
+
+  // The square root of 1 wasn't 1 or -1.
+  if( x.isOne())
+    return false;
+
+  }
+
+return false;
+}
+
+
+
+bool MillerRabin::testBase( const Integer& n,
+                            const Integer& base,
+                            IntegerMath& intMath )
+{
+if( n.getNegative() ||
+    ((n.getD( 0 ) & 1) == 0) ||
+    ((n.getIndex() == 0) && (n.getD( 0 ) <= 3)))
+  throw "MillerRabin.testBase() bad n.";
+
+setupOddPart( n );
+return isStrongProbable( n, base, intMath );
+}
+
+
+
+bool MillerRabin::isProbablePrime(
+                     const Integer& n,
+                     const Int32 randomRounds,
+                     const SPrimes& sPrimes,
+                     IntegerMath& intMath )
+{
+auto startTime = std::chrono::steady_clock::now();
+
+lastRounds = 0;
+bool result = runTest( n, randomRounds,
+                       sPrimes, intMath );
+
+auto endTime = std::chrono::steady_clock::now();
+lastMicroSeconds = std::chrono::duration_cast<
+                   std::chrono::microseconds>(
+                   endTime - startTime ).count();
+
+totalTests++;
+totalRounds += lastRounds;
+totalMicroSeconds += lastMicroSeconds;
+return result;
+}
+
+
+
+bool MillerRabin::runTest( const Integer& n,
+                           const Int32 randomRounds,
+                           const SPrimes& sPrimes,
+                           IntegerMath& intMath )
+{
+if( n.getNegative() )
+  return false;
+
+if( n.getIndex() == 0 )
+  {
+  if( n.getD( 0 ) < 2 )
+    return false;
+
+  if( n.getD( 0 ) <= 3 )
+    return true;
+
+  }
+
+Int32 smallPrime = intMath.isDivisibleBySmallPrime(
+                                   n, sPrimes );
+if( smallPrime != 0 )
+  return n.isEqualToInt24( smallPrime );
+
+setupOddPart( n );
+
+Integer base;
+if( n.paramIsGreater( deterministicLimit ))
+  {
+  Int32 howMany = 13; // 2 through 41.
+  if( isLessThan2To64( n ))
+    howMany = 12; // 2 through 37.
+
+  for( Int32 count = 0; count < howMany;
+                                     count++ )
+    {
+    base.setFromLong48( sPrimes.getPrimeAt(
+                                     count ));
+    lastRounds++;
+    if( !isStrongProbable( n, base, intMath ))
+      return false;
+
+    }
+
+  return true;
+  }
+
+base.setFromLong48( 2 );
+lastRounds++;
+if( !isStrongProbable( n, base, intMath ))
+  return false;
+
+// A random witness that is one digit shorter
+// than n.  It has to be more than 1 and
+// less than n - 1.
+const Int32 baseIndex = n.getIndex() - 1;
+for( Int32 count = 0; count < randomRounds;
+                                      count++ )
+  {
+  bool found = false;
+  for( Int32 tries = 0; tries < 100; tries++ )
+    {
+    if( !base.makeRandomOdd( baseIndex ))
+      continue;
+
+    if( (base.getIndex() == 0) &&
+        (base.getD( 0 ) <= 1) )
+      continue;
+
+    if( !base.paramIsGreater( nMinus1 ))
+      continue;
+
+    found = true;
+    break;
+    }
+
+  if( !found )
+    throw "MillerRabin random base.";
+
+  lastRounds++;
+  if( !isStrongProbable( n, base, intMath ))
+    return false;
+
+  }
+
+return true;
+}
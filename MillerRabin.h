@@ -0,0 +1,135 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// The Miller-Rabin strong probable prime test.
+
+// The modulus is the same for every witness
+// of one candidate, so all of the rounds use
+// the same Mod object.  The NumbSys tables in
+// it only get made again when the modulus
+// changes.
+
+// For numbers less than
+// 3,317,044,064,679,887,385,961,981 the
+// witnesses 2 through 41 are known to be
+// enough, so those aren't random.  (For
+// less than 2^64 the witnesses 2 through 37
+// are enough.)  See Jiang and Deng, "Strong
+// pseudoprimes to twelve prime bases" (2014).
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "Mod.h"
+#include "../CryptoBase/SPrimes.h"
+
+
+
+class MillerRabin
+  {
+  private:
+  bool testForCopy = false;
+  Mod mod;
+  Integer deterministicLimit;
+  Integer nMinus1;
+  Integer oddPart;
+  Integer witness;
+  Integer x;
+  Integer temp;
+  Int32 twoPower = 0;
+
+  Int32 lastRounds = 0;
+  Int64 lastMicroSeconds = 0;
+  Int64 totalTests = 0;
+  Int64 totalRounds = 0;
+  Int64 totalMicroSeconds = 0;
+
+  static bool isLessThan2To64( const Integer& n );
+  void setupOddPart( const Integer& n );
+  bool isStrongProbable( const Integer& n,
+                         const Integer& base,
+                         IntegerMath& intMath );
+
+  bool runTest( const Integer& n,
+                const Int32 randomRounds,
+                const SPrimes& sPrimes,
+                IntegerMath& intMath );
+
+  public:
+  MillerRabin( void );
+
+  MillerRabin( const MillerRabin& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "MillerRabin copy constructor.";
+    }
+
+  ~MillerRabin( void )
+    {
+    }
+
+  // For numbers that are too big for the
+  // fixed witnesses, base 2 is done first,
+  // then randomRounds random witnesses.
+  bool isProbablePrime( const Integer& n,
+                        const Int32 randomRounds,
+                        const SPrimes& sPrimes,
+                        IntegerMath& intMath );
+
+  // The Mod that goes with the last n, for
+  // more tests on the same candidate.
+  inline Mod& getMod( void )
+    {
+    return mod;
+    }
+
+  // One round with a given base.
+  // n has to be odd and more than 3.
+  bool testBase( const Integer& n,
+                 const Integer& base,
+                 IntegerMath& intMath );
+
+  // The number of toPower() rounds and the
+  // time for the last isProbablePrime().
+  inline Int32 getLastRounds( void ) const
+    {
+    return lastRounds;
+    }
+
+  inline Int64 getLastMicroSeconds( void ) const
+    {
+    return lastMicroSeconds;
+    }
+
+  inline Int64 getTotalTests( void ) const
+    {
+    return totalTests;
+    }
+
+  inline Int64 getTotalRounds( void ) const
+    {
+    return totalRounds;
+    }
+
+  inline Int64 getTotalMicroSeconds( void ) const
+    {
+    return totalMicroSeconds;
+    }
+
+  void clearStats( void );
+
+  };
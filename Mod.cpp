@@ -10,10 +10,13 @@
 #include "Mod.h"
 #include "Division.h"
 // #include "Exponents.h"
-#include "../CryptoBase/Euclid.h"
+#include "LehmerGcd.h"
 #include "../CppBase/StIO.h"
 
 
+#include "../CppMem/MemoryWarnTop.h"
+
+
 
 
 void Mod::reduce( Integer& result,
@@ -41,13 +44,10 @@ void Mod::makeExact( Integer& exact,
 // of that small left over multiple of the
 // modulus.
 
-Integer quotient;
-Integer remainder;
-
-Division::divide( exact, modulus,
-                  quotient, remainder, intMath );
-
-exact.copy( remainder );
+// Only the remainder is needed here, and it
+// can be written right back in to exact.
+Division::remainderOnly( exact, modulus,
+                         exact, intMath );
 }
 
 
@@ -197,6 +197,194 @@ makeExact( result, modulus, intMath );
 
 
 
+void Mod::toPower( Integer& result,
+                   const FixedExponent& exponent,
+                   const Integer& modulus,
+                   IntegerMath& intMath )
+{
+// The same special cases as the other
+// toPower().
+if( result.isZero())
+  return;
+
+if( result.isEqual( modulus ))
+  {
+  result.setToZero();
+  return;
+  }
+
+if( exponent.isZero())
+  {
+  result.setToOne();
+  return;
+  }
+
+if( modulus.paramIsGreater( result ))
+  makeExact( result, modulus, intMath );
+
+// table[count] is the base to the power
+// (2 * count) + 1.
+const Int32 tableSize = exponent.getTableSize();
+Integer* table = new Integer[tableSize];
+Integer temp;
+table[0].copy( result );
+if( tableSize > 1 )
+  {
+  Integer square;
+  square.copy( result );
+  intMath.multiply( square, result );
+  reduce( temp, square, modulus, intMath );
+  square.copy( temp );
+  for( Int32 count = 1; count < tableSize;
+                                      count++ )
+    {
+    temp.copy( table[count - 1] );
+    intMath.multiply( temp, square );
+    reduce( table[count], temp, modulus,
+                                   intMath );
+    }
+  }
+
+const Int32 stepCount = exponent.getStepCount();
+result.copy( table[exponent.getDigit( 0 ) >> 1] );
+for( Int32 step = 1; step < stepCount; step++ )
+  {
+  const Int32 squarings =
+                   exponent.getSquarings( step );
+  for( Int32 count = 0; count < squarings;
+                                      count++ )
+    {
+    intMath.multiply( result, result );
+    reduce( temp, result, modulus, intMath );
+    result.copy( temp );
+    }
+
+  const Int32 digit = exponent.getDigit( step );
+  if( digit != 0 )
+    {
+    intMath.multiply( result, table[digit >> 1] );
+    reduce( temp, result, modulus, intMath );
+    result.copy( temp );
+    }
+  }
+
+delete[] table;
+
+makeExact( result, modulus, intMath );
+}
+
+
+
+// Ernst Straus, "Addition chains of vectors",
+// American Mathematical Monthly, 1964.  It is
+// also called Shamir's trick.
+
+void Mod::multiExp( Integer& result,
+                    const Integer* bases,
+                    const Integer* exponents,
+                    const Int32 howMany,
+                    const Integer& modulus,
+                    IntegerMath& intMath )
+{
+if( howMany < 1 )
+  throw "Mod.multiExp() howMany < 1.";
+
+const Int32 tableSize = 1 << MultiExpWindow;
+const Int64 windowMask = tableSize - 1;
+
+Int32 maxIndex = 0;
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  if( exponents[count].getNegative() ||
+      bases[count].getNegative())
+    throw "Mod.multiExp() negative.";
+
+  if( maxIndex < exponents[count].getIndex())
+    maxIndex = exponents[count].getIndex();
+
+  }
+
+// table[(count * tableSize) + power] is
+// bases[count]^power.  Like in toPower() they
+// are reduced but not exact.
+Integer temp;
+Integer* table = new Integer[howMany * tableSize];
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  if( exponents[count].isZero())
+    continue;
+
+  Integer* row = &table[count * tableSize];
+  row[1].copy( bases[count] );
+  if( modulus.paramIsGreaterOrEq( row[1] ))
+    makeExact( row[1], modulus, intMath );
+
+  for( Int32 power = 2; power < tableSize;
+                                      power++ )
+    {
+    temp.copy( row[power - 1] );
+    intMath.multiply( temp, row[1] );
+    reduce( row[power], temp, modulus, intMath );
+    }
+  }
+
+// Nothing gets squared until the first
+// window that isn't zero.
+bool started = false;
+result.setToOne();
+for( Int32 digit = maxIndex; digit >= 0; digit-- )
+  {
+  for( Int32 shiftBy = 24 - MultiExpWindow;
+                shiftBy >= 0;
+                shiftBy -= MultiExpWindow )
+    {
+    if( started )
+      {
+      for( Int32 count = 0; count < MultiExpWindow;
+                                       count++ )
+        {
+        intMath.multiply( result, result );
+        reduce( temp, result, modulus, intMath );
+        result.copy( temp );
+        }
+      }
+
+    for( Int32 count = 0; count < howMany;
+                                      count++ )
+      {
+      const Integer& exponent = exponents[count];
+      if( digit > exponent.getIndex())
+        continue;
+
+      const Int32 window = static_cast<Int32>(
+                  (exponent.getD( digit ) >> shiftBy)
+                  & windowMask );
+      if( window == 0 )
+        continue;
+
+      const Integer& power = table[
+                   (count * tableSize) + window];
+      if( !started )
+        {
+        result.copy( power );
+        started = true;
+        continue;
+        }
+
+      intMath.multiply( result, power );
+      reduce( temp, result, modulus, intMath );
+      result.copy( temp );
+      }
+    }
+  }
+
+delete[] table;
+
+makeExact( result, modulus, intMath );
+}
+
+
+
 void Mod::verifyInBaseRange(
                      const Integer& toCheck,
                      const Integer& modulus,
@@ -445,11 +633,11 @@ if( divisor.isOne())
 Integer inverse;
 
 // Get the multiplicative inverse.
-if( !Euclid::multInverse( divisor,
-                          modulus,
-                          inverse,
-                          gcd,
-                          intMath ))
+if( !LehmerGcd::multInverse( divisor,
+                             modulus,
+                             inverse,
+                             gcd,
+                             intMath ))
   return false;
 
 verifyInBaseRange( result, modulus,
@@ -465,3 +653,104 @@ result.copy( temp );
 makeExact( result, modulus, intMath );
 return true;
 }
+
+
+
+// Montgomery's trick.  Peter Montgomery,
+// "Speeding the Pollard and Elliptic Curve
+// Methods of Factorization" (1987).
+// It multiplies all of them together, gets
+// one inverse of the product, and then gets
+// each inverse back out of that with
+// multiplications.  That is one extended
+// gcd and 3(howMany - 1) multiplications
+// instead of howMany extended gcds.
+
+Int32 Mod::batchInvert( Integer* toInvert,
+                        const Int32 howMany,
+                        const Integer& modulus,
+                        Integer& gcd,
+                        IntegerMath& intMath )
+{
+if( howMany < 1 )
+  throw "Mod.batchInvert() howMany < 1.";
+
+for( Int32 count = 0; count < howMany; count++ )
+  verifyInBaseRange( toInvert[count], modulus,
+                     "Mod.batchInvert() toInvert" );
+
+// prefix[i] is the product of toInvert[0]
+// through toInvert[i].
+Integer* prefix = new Integer[howMany];
+prefix[0].copy( toInvert[0] );
+for( Int32 count = 1; count < howMany; count++ )
+  {
+  prefix[count].copy( prefix[count - 1] );
+  multiply( prefix[count], toInvert[count],
+            modulus, intMath );
+  }
+
+Integer inverse;
+if( !LehmerGcd::multInverse(
+                          prefix[howMany - 1],
+                          modulus,
+                          inverse,
+                          gcd,
+                          intMath ))
+  {
+  // A prefix product can be inverted only if
+  // every number in it can, so a binary
+  // search on the prefixes finds the first
+  // one that can't be.
+  Int32 low = 0;
+  Int32 high = howMany - 1;
+  while( low < high )
+    {
+    const Int32 middle = (low + high) / 2;
+    if( LehmerGcd::multInverse( prefix[middle],
+                                modulus,
+                                inverse,
+                                gcd,
+                                intMath ))
+      low = middle + 1;
+    else
+      high = middle;
+
+    }
+
+  LehmerGcd::multInverse( toInvert[low],
+                          modulus,
+                          inverse,
+                          gcd,
+                          intMath );
+  delete[] prefix;
+  return low;
+  }
+
+// Going back down, inverse is the inverse of
+// prefix[count].
+Integer temp;
+for( Int32 count = howMany - 1; count >= 1;
+                                      count-- )
+  {
+  // The inverse of toInvert[count] is
+  // inverse * prefix[count - 1].
+  temp.copy( inverse );
+  multiply( temp, prefix[count - 1], modulus,
+            intMath );
+
+  // Now the inverse of prefix[count - 1].
+  multiply( inverse, toInvert[count], modulus,
+            intMath );
+
+  toInvert[count].copy( temp );
+  }
+
+toInvert[0].copy( inverse );
+delete[] prefix;
+return -1;
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
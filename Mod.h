@@ -18,6 +18,7 @@
 #include "../CppBase/BasicTypes.h"
 #include "../CppInt/Integer.h"
 #include "../CppInt/NumbSys.h"
+#include "../CppInt/FixedExponent.h"
 
 
 class Mod
@@ -26,6 +27,10 @@ class Mod
   bool testForCopy = false;
   NumbSys numbSys;
 
+  // In bits.  It has to divide 24 so that a
+  // window never crosses a digit.
+  static const Int32 MultiExpWindow = 4;
+
   public:
   inline Mod( void )
     {
@@ -58,6 +63,30 @@ class Mod
                 const Integer& modulus,
                 IntegerMath& intMath );
 
+  // The same as toPower() with
+  // exponent.getExponent(), but the windows
+  // were worked out ahead of time.
+  void toPower( Integer& result,
+                const FixedExponent& exponent,
+                const Integer& modulus,
+                IntegerMath& intMath );
+
+  // result = the product of
+  // bases[count]^exponents[count] mod modulus.
+  // This is Straus's method.  The exponents
+  // are gone through together, MultiExpWindow
+  // bits at a time, so the squarings are
+  // shared by all of them, and each base has
+  // a table of its powers up to the size of
+  // a window.  For two pairs it costs about
+  // as much as one toPower().
+  void multiExp( Integer& result,
+                 const Integer* bases,
+                 const Integer* exponents,
+                 const Int32 howMany,
+                 const Integer& modulus,
+                 IntegerMath& intMath );
+
   void verifyInBaseRange(
                      const Integer& toCheck,
                      const Integer& modulus,
@@ -106,4 +135,17 @@ class Mod
                Integer& gcd,
                IntegerMath& intMath );
 
+  // This replaces each of the howMany numbers
+  // in toInvert with its inverse.  It returns
+  // -1 if that worked.  If a number can't be
+  // inverted it returns the index of the
+  // first one that can't, gcd is set to its
+  // gcd with the modulus, and toInvert is
+  // not changed.
+  Int32 batchInvert( Integer* toInvert,
+                     const Int32 howMany,
+                     const Integer& modulus,
+                     Integer& gcd,
+                     IntegerMath& intMath );
+
   };
@@ -0,0 +1,358 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "ModExpPool.h"
+
+#include <chrono>
+#include <algorithm>
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+ModExpPool::ModExpPool( const Int32 setThreadCount )
+{
+if( (setThreadCount < 1) ||
+    (setThreadCount > MaxThreads) )
+  throw "ModExpPool threadCount range.";
+
+threadCount = setThreadCount;
+mods = new Mod[threadCount];
+intMaths = new IntegerMath[threadCount];
+ranges = new std::atomic<Uint64>[threadCount];
+for( Int32 count = 0; count < threadCount;
+                                      count++ )
+  ranges[count].store( 0 );
+
+stolenCount.store( 0 );
+cancelled.store( false );
+workerError.store( nullptr );
+
+threads = new std::thread[threadCount];
+for( Int32 count = 1; count < threadCount;
+                                      count++ )
+  threads[count] = std::thread(
+                          &ModExpPool::threadLoop,
+                          this, count );
+
+}
+
+
+
+ModExpPool::~ModExpPool( void )
+{
+  {
+  std::lock_guard<std::mutex> lock( batchMutex );
+  shuttingDown = true;
+  }
+
+batchStart.notify_all();
+
+for( Int32 count = 1; count < threadCount;
+                                      count++ )
+  threads[count].join();
+
+delete[] threads;
+delete[] mods;
+delete[] intMaths;
+delete[] ranges;
+delete[] latencies;
+}
+
+
+
+bool ModExpPool::takeFront( const Int32 which,
+                            Int32& job )
+{
+std::atomic<Uint64>& range = ranges[which];
+Uint64 bounds = range.load();
+while( true )
+  {
+  const Uint64 front = bounds & 0xFFFFFFFFULL;
+  const Uint64 back = bounds >> 32;
+  if( front >= back )
+    return false;
+
+  if( range.compare_exchange_weak( bounds,
+                                   bounds + 1 ))
+    {
+    job = static_cast<Int32>( front );
+    return true;
+    }
+  }
+}
+
+
+
+bool ModExpPool::takeBack( const Int32 which,
+                           Int32& job )
+{
+std::atomic<Uint64>& range = ranges[which];
+Uint64 bounds = range.load();
+while( true )
+  {
+  const Uint64 front = bounds & 0xFFFFFFFFULL;
+  const Uint64 back = bounds >> 32;
+  if( front >= back )
+    return false;
+
+  const Uint64 newBounds = ((back - 1) << 32) |
+                                         front;
+  if( range.compare_exchange_weak( bounds,
+                                   newBounds ))
+    {
+    job = static_cast<Int32>( back - 1 );
+    return true;
+    }
+  }
+}
+
+
+
+void ModExpPool::doJob( const Int32 thread,
+                        const Int32 job )
+{
+const auto start = std::chrono::steady_clock::now();
+
+results[job].copy( bases[job] );
+mods[thread].toPower( results[job],
+                      exponents[job],
+                      moduli[job],
+                      intMaths[thread] );
+
+const auto end = std::chrono::steady_clock::now();
+latencies[job] = std::chrono::duration_cast<
+                 std::chrono::microseconds>(
+                            end - start ).count();
+}
+
+
+
+void ModExpPool::worker( const Int32 thread )
+{
+try
+{
+runJobs( thread );
+}
+catch( const char* in )
+  {
+  workerError.store( in );
+  cancelled.store( true );
+  }
+catch( ... )
+  {
+  workerError.store(
+            "ModExpPool worker exception." );
+  cancelled.store( true );
+  }
+}
+
+
+
+// Each thread waits here for the next batch
+// until the destructor says to stop.
+
+void ModExpPool::threadLoop( const Int32 thread )
+{
+Int64 lastBatch = 0;
+while( true )
+  {
+    {
+    std::unique_lock<std::mutex> lock(
+                                  batchMutex );
+    while( !shuttingDown &&
+           (batchNumber == lastBatch) )
+      batchStart.wait( lock );
+
+    if( shuttingDown )
+      return;
+
+    lastBatch = batchNumber;
+    }
+
+  worker( thread );
+
+    {
+    std::lock_guard<std::mutex> lock(
+                                  batchMutex );
+    busyThreads--;
+    }
+
+  batchDone.notify_one();
+  }
+}
+
+
+
+void ModExpPool::runJobs( const Int32 thread )
+{
+Int32 job = 0;
+while( !cancelled.load() )
+  {
+  if( takeFront( thread, job ))
+    {
+    doJob( thread, job );
+    continue;
+    }
+
+  // Its own range is empty, so look for
+  // one that isn't, starting at the next
+  // thread.
+  bool found = false;
+  for( Int32 count = 1; count < threadCount;
+                                      count++ )
+    {
+    const Int32 victim = (thread + count) %
+                                   threadCount;
+    if( takeBack( victim, job ))
+      {
+      found = true;
+      break;
+      }
+    }
+
+  if( !found )
+    return;
+
+  stolenCount.fetch_add( 1 );
+  doJob( thread, job );
+  }
+}
+
+
+
+void ModExpPool::run( const Integer* setBases,
+                      const Integer* setExponents,
+                      const Integer* setModuli,
+                      Integer* setResults,
+                      const Int32 howMany )
+{
+if( howMany < 0 )
+  throw "ModExpPool howMany < 0.";
+
+bases = setBases;
+exponents = setExponents;
+moduli = setModuli;
+results = setResults;
+jobCount = howMany;
+
+if( howMany > latenciesSize )
+  {
+  delete[] latencies;
+  latencies = new Int64[howMany];
+  latenciesSize = howMany;
+  }
+
+// A job that doesn't get done because
+// another one threw keeps the -1.
+for( Int32 count = 0; count < howMany; count++ )
+  latencies[count] = -1;
+
+stolenCount.store( 0 );
+cancelled.store( false );
+workerError.store( nullptr );
+
+if( howMany == 0 )
+  return;
+
+// Each thread starts out with an equal
+// share.
+for( Int32 count = 0; count < threadCount;
+                                      count++ )
+  {
+  const Uint64 front = static_cast<Uint64>(
+           (static_cast<Int64>( howMany ) * count) /
+                                    threadCount );
+  const Uint64 back = static_cast<Uint64>(
+     (static_cast<Int64>( howMany ) * (count + 1)) /
+                                    threadCount );
+  ranges[count].store( (back << 32) | front );
+  }
+
+// Wake up the other threads.  This thread
+// is thread 0.
+  {
+  std::lock_guard<std::mutex> lock( batchMutex );
+  batchNumber++;
+  busyThreads = threadCount - 1;
+  }
+
+batchStart.notify_all();
+
+worker( 0 );
+
+  {
+  std::unique_lock<std::mutex> lock( batchMutex );
+  while( busyThreads != 0 )
+    batchDone.wait( lock );
+
+  }
+
+const char* error = workerError.load();
+if( error != nullptr )
+  throw error;
+
+}
+
+
+
+Int64 ModExpPool::getLatency( const Int32 job ) const
+{
+if( (job < 0) || (job >= jobCount) )
+  throw "ModExpPool.getLatency() range.";
+
+return latencies[job];
+}
+
+
+
+Int64 ModExpPool::getLatencyPercentile(
+                       const Int32 percent ) const
+{
+if( (percent < 0) || (percent > 100) )
+  throw "ModExpPool percent range.";
+
+// Only the jobs that got done.
+Int64* sorted = new Int64[jobCount + 1];
+Int32 doneCount = 0;
+for( Int32 count = 0; count < jobCount; count++ )
+  {
+  if( latencies[count] < 0 )
+    continue;
+
+  sorted[doneCount] = latencies[count];
+  doneCount++;
+  }
+
+if( doneCount == 0 )
+  {
+  delete[] sorted;
+  return 0;
+  }
+
+std::sort( sorted, sorted + doneCount );
+
+// The nearest rank.
+Int32 where = static_cast<Int32>(
+            ((static_cast<Int64>( doneCount ) *
+              percent) + 99) / 100 ) - 1;
+if( where < 0 )
+  where = 0;
+
+const Int64 result = sorted[where];
+delete[] sorted;
+return result;
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
@@ -0,0 +1,152 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// This does a batch of Mod::toPower() jobs on
+// more than one thread.  A Mod and an
+// IntegerMath can't be shared between
+// threads, so each thread has its own, and
+// they are kept from one batch to the next
+// so a NumbSys that already has the base
+// array for a modulus doesn't have to set it
+// up again.
+
+// The threads are started by the constructor
+// and wait on a condition variable between
+// batches, so a small batch doesn't pay for
+// starting threads.  The thread that calls
+// run() is thread 0.  The destructor stops
+// and joins them.
+
+// The jobs are split up in to one range for
+// each thread.  A thread takes jobs from the
+// front of its own range, and when that runs
+// out it steals from the back of another
+// thread's range.  The front and the back
+// of a range are in one atomic, so taking
+// from either end is one compare and swap.
+// Each result goes in the same place as its
+// job, so they come back in order no matter
+// which thread did them.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "Mod.h"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+
+class ModExpPool
+  {
+  private:
+  bool testForCopy = false;
+  static const Int32 MaxThreads = 256;
+  Int32 threadCount = 0;
+
+  // One for each thread.
+  Mod* mods = nullptr;
+  IntegerMath* intMaths = nullptr;
+
+  // The low 32 bits are the front and the high
+  // 32 bits are one past the back.
+  std::atomic<Uint64>* ranges = nullptr;
+
+  // In microseconds, for each job.
+  Int64* latencies = nullptr;
+  Int32 latenciesSize = 0;
+  Int32 jobCount = 0;
+
+  // Threads 1 to threadCount - 1.  Thread 0
+  // is whoever calls run().
+  std::thread* threads = nullptr;
+  std::mutex batchMutex;
+  std::condition_variable batchStart;
+  std::condition_variable batchDone;
+
+  // These are guarded by batchMutex.
+  Int64 batchNumber = 0;
+  Int32 busyThreads = 0;
+  bool shuttingDown = false;
+
+  std::atomic<Int64> stolenCount;
+  std::atomic<bool> cancelled;
+  std::atomic<const char*> workerError;
+
+  const Integer* bases = nullptr;
+  const Integer* exponents = nullptr;
+  const Integer* moduli = nullptr;
+  Integer* results = nullptr;
+
+  bool takeFront( const Int32 which, Int32& job );
+  bool takeBack( const Int32 which, Int32& job );
+  void doJob( const Int32 thread,
+              const Int32 job );
+  void worker( const Int32 thread );
+  void runJobs( const Int32 thread );
+  void threadLoop( const Int32 thread );
+
+  public:
+  ModExpPool( const Int32 setThreadCount );
+
+  ModExpPool( const ModExpPool& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "ModExpPool copy constructor.";
+    }
+
+  ~ModExpPool( void );
+
+  inline Int32 getThreadCount( void ) const
+    {
+    return threadCount;
+    }
+
+  // setResults[count] = setBases[count] to the
+  // power setExponents[count] mod
+  // setModuli[count].  Only one run() at a
+  // time.
+  void run( const Integer* setBases,
+            const Integer* setExponents,
+            const Integer* setModuli,
+            Integer* setResults,
+            const Int32 howMany );
+
+  // These are for the last run().
+
+  // How long the job took, in microseconds.
+  // It is -1 if the job didn't get done
+  // because run() threw.
+  Int64 getLatency( const Int32 job ) const;
+
+  // percent is 0 to 100.  50 is the median
+  // and 100 is the slowest job.  Jobs that
+  // didn't get done are left out.
+  Int64 getLatencyPercentile(
+                        const Int32 percent ) const;
+
+  // How many jobs were done by a thread
+  // other than the one they started out with.
+  inline Int64 getStolenCount( void ) const
+    {
+    return stolenCount.load();
+    }
+
+  };
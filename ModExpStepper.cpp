@@ -0,0 +1,216 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "ModExpStepper.h"
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+void ModExpStepper::finish( const Integer& setTo )
+{
+result.copy( setTo );
+done = true;
+}
+
+
+
+void ModExpStepper::start( const Integer& base,
+                           const Integer& setExponent,
+                           const Integer& setModulus,
+                           Mod& mod,
+                           IntegerMath& intMath )
+{
+if( setExponent.getNegative())
+  throw "ModExpStepper exponent is negative.";
+
+started = true;
+done = false;
+multiplyCount = 0;
+bitIndex = 0;
+multiplyDone = false;
+exponent.copy( setExponent );
+modulus.copy( setModulus );
+
+// The same special cases as toPower().
+if( base.isZero())
+  {
+  finish( base );
+  return;
+  }
+
+if( base.isEqual( modulus ))
+  {
+  temp.setToZero();
+  finish( temp );
+  return;
+  }
+
+if( exponent.isZero())
+  {
+  temp.setToOne();
+  finish( temp );
+  return;
+  }
+
+X.copy( base );
+if( modulus.paramIsGreater( X ))
+  mod.makeExact( X, modulus, intMath );
+
+if( exponent.isOne())
+  {
+  finish( X );
+  return;
+  }
+
+bitLength = exponent.getIndex() * 24;
+Int64 top = exponent.getD( exponent.getIndex());
+while( top != 0 )
+  {
+  bitLength++;
+  top >>= 1;
+  }
+
+result.setToOne();
+}
+
+
+
+bool ModExpStepper::step( const Int32 maxMultiplies,
+                          Mod& mod,
+                          IntegerMath& intMath )
+{
+if( !started )
+  throw "ModExpStepper.step() not started.";
+
+if( maxMultiplies < 1 )
+  throw "ModExpStepper.step() maxMultiplies < 1.";
+
+Int32 count = 0;
+while( !done && (count < maxMultiplies) )
+  {
+  if( bitIndex >= bitLength )
+    {
+    mod.makeExact( result, modulus, intMath );
+    done = true;
+    break;
+    }
+
+  if( !multiplyDone )
+    {
+    multiplyDone = true;
+    const Int64 bit = (exponent.getD( bitIndex / 24 )
+                       >> (bitIndex % 24)) & 1;
+    if( bit == 1 )
+      {
+      intMath.multiply( result, X );
+      mod.reduce( temp, result, modulus, intMath );
+      result.copy( temp );
+      count++;
+      }
+
+    continue;
+    }
+
+  // The square for the next bit, if there
+  // is one.
+  multiplyDone = false;
+  bitIndex++;
+  if( bitIndex < bitLength )
+    {
+    intMath.multiply( X, X );
+    mod.reduce( temp, X, modulus, intMath );
+    X.copy( temp );
+    count++;
+    }
+  }
+
+multiplyCount += count;
+return done;
+}
+
+
+
+const Integer& ModExpStepper::getResult( void ) const
+{
+if( !done )
+  throw "ModExpStepper.getResult() not done.";
+
+return result;
+}
+
+
+
+#if defined( __cpp_impl_coroutine )
+
+bool ModExpTask::resume( void )
+{
+if( !handle )
+  throw "ModExpTask.resume() no coroutine.";
+
+// Once it has thrown it stays done, and the
+// error comes back each time.
+if( !handle.done())
+  handle.resume();
+
+if( handle.promise().error )
+  std::rethrow_exception( handle.promise().error );
+
+return handle.done();
+}
+
+
+
+void ModExpTask::Awaiter::await_suspend(
+               std::coroutine_handle<> setWaiting )
+{
+promise_type& promise = task->handle.promise();
+if( promise.waiting )
+  throw "ModExpTask is already co_awaited.";
+
+promise.waiting = setWaiting;
+}
+
+
+
+const Integer& ModExpTask::Awaiter::await_resume(
+                                   void ) const
+{
+if( !task->handle )
+  throw "ModExpTask.await_resume() no coroutine.";
+
+promise_type& promise = task->handle.promise();
+if( promise.error )
+  std::rethrow_exception( promise.error );
+
+return promise.stepper->getResult();
+}
+
+
+
+ModExpTask ModExpTask::makeTask(
+                       ModExpStepper& stepper,
+                       const Int32 maxMultiplies,
+                       Mod& mod,
+                       IntegerMath& intMath )
+{
+while( !stepper.step( maxMultiplies, mod,
+                                 intMath ))
+  co_await std::suspend_always();
+
+}
+
+#endif
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
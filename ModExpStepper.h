@@ -0,0 +1,280 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// Mod::toPower() split up so it can be done
+// a few multiplies at a time.  A 4096 bit
+// power takes milliseconds, so an event loop
+// with a lot of them can call step() on each
+// one in turn, with a limit on how many
+// multiplies each step does, and nothing
+// else on that thread has to wait for a
+// whole power to finish.
+
+// It is the same right to left binary method
+// as toPower(), with the same reduce() after
+// each multiply, so it gives the same
+// answer.  All of the state is in here, so
+// steppers with the same modulus can share a
+// Mod and an IntegerMath.  With different
+// moduli they can still share, but NumbSys
+// sets up its base array again each time the
+// modulus changes, so each modulus should
+// have its own Mod.
+
+// With C++20 coroutines there is also
+// ModExpTask, which does one step each time
+// it is resumed, and which another coroutine
+// can co_await.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "Mod.h"
+
+#if defined( __cpp_impl_coroutine )
+#include <coroutine>
+#include <exception>
+#endif
+
+
+
+class ModExpStepper
+  {
+  private:
+  bool testForCopy = false;
+  bool started = false;
+  bool done = false;
+  Integer X;
+  Integer result;
+  Integer exponent;
+  Integer modulus;
+  Integer temp;
+  Int32 bitLength = 0;
+  Int32 bitIndex = 0;
+
+  // The multiply for bitIndex is done, and
+  // the squaring for the next bit is not.
+  bool multiplyDone = false;
+
+  Int64 multiplyCount = 0;
+
+  void finish( const Integer& setTo );
+
+  public:
+  ModExpStepper( void )
+    {
+    }
+
+  ModExpStepper( const ModExpStepper& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "ModExpStepper copy constructor.";
+    }
+
+  ~ModExpStepper( void )
+    {
+    }
+
+  // The easy cases are done right here, so it
+  // might be done before the first step().
+  void start( const Integer& base,
+              const Integer& setExponent,
+              const Integer& setModulus,
+              Mod& mod,
+              IntegerMath& intMath );
+
+  // This does up to maxMultiplies multiplies,
+  // counting squarings.  It returns true when
+  // the power is done.
+  bool step( const Int32 maxMultiplies,
+             Mod& mod,
+             IntegerMath& intMath );
+
+  inline bool isDone( void ) const
+    {
+    return done;
+    }
+
+  // All of the multiplies so far.
+  inline Int64 getMultiplyCount( void ) const
+    {
+    return multiplyCount;
+    }
+
+  const Integer& getResult( void ) const;
+
+  };
+
+
+
+#if defined( __cpp_impl_coroutine )
+
+// The coroutine from makeTask() does
+// maxMultiplies at a time and then suspends.
+// An event loop calls resume() on each task
+// in turn.  resume() returns true when the
+// power is done, and then the answer is in
+// stepper.getResult().  If the stepper threw,
+// resume() throws it again every time it's
+// called after that.  The stepper, mod and
+// intMath have to last as long as the task.
+
+// Another coroutine can co_await the task.
+// That doesn't run the task.  The loop still
+// has to call resume() on it, and the one
+// waiting gets resumed from inside the
+// resume() that finishes it.  co_await gives
+// back stepper.getResult(), or throws what
+// the stepper threw.  The loop owns the task,
+// so it has to be co_awaited by reference,
+// and only one coroutine at a time can wait
+// on it.
+
+class ModExpTask
+  {
+  public:
+  struct promise_type;
+
+  private:
+  struct FinalAwaiter
+    {
+    bool await_ready( void ) noexcept
+      {
+      return false;
+      }
+
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<promise_type> done )
+                                      noexcept
+      {
+      if( done.promise().waiting )
+        return done.promise().waiting;
+
+      return std::noop_coroutine();
+      }
+
+    void await_resume( void ) noexcept
+      {
+      }
+    };
+
+  public:
+  struct promise_type
+    {
+    ModExpStepper* stepper = nullptr;
+    std::coroutine_handle<> waiting;
+    std::exception_ptr error;
+
+    // These are the arguments to makeTask().
+    promise_type( ModExpStepper& setStepper,
+                  const Int32 maxMultiplies,
+                  Mod& mod,
+                  IntegerMath& intMath )
+      {
+      stepper = &setStepper;
+      }
+
+    ModExpTask get_return_object( void )
+      {
+      return ModExpTask(
+          std::coroutine_handle<promise_type>::
+                            from_promise( *this ));
+      }
+
+    std::suspend_always initial_suspend( void )
+      {
+      return {};
+      }
+
+    FinalAwaiter final_suspend( void ) noexcept
+      {
+      return {};
+      }
+
+    void return_void( void )
+      {
+      }
+
+    void unhandled_exception( void )
+      {
+      error = std::current_exception();
+      }
+    };
+
+  private:
+  std::coroutine_handle<promise_type> handle;
+
+  explicit ModExpTask(
+       std::coroutine_handle<promise_type> setHandle )
+    {
+    handle = setHandle;
+    }
+
+  public:
+  ModExpTask( const ModExpTask& in ) = delete;
+
+  ModExpTask( ModExpTask&& in ) noexcept
+    {
+    handle = in.handle;
+    in.handle = nullptr;
+    }
+
+  ~ModExpTask( void )
+    {
+    if( handle )
+      handle.destroy();
+
+    }
+
+  inline bool isDone( void ) const
+    {
+    return !handle || handle.done();
+    }
+
+  bool resume( void );
+
+  static ModExpTask makeTask(
+                       ModExpStepper& stepper,
+                       const Int32 maxMultiplies,
+                       Mod& mod,
+                       IntegerMath& intMath );
+
+  // What co_await uses.  It only works on a
+  // task that isn't a temporary, since the
+  // loop has to have it.
+  struct Awaiter
+    {
+    ModExpTask* task = nullptr;
+
+    inline bool await_ready( void ) const
+      {
+      return task->isDone();
+      }
+
+    void await_suspend(
+               std::coroutine_handle<> setWaiting );
+    const Integer& await_resume( void ) const;
+    };
+
+  inline Awaiter operator co_await( void ) &
+    {
+    return Awaiter{ this };
+    }
+
+  };
+
+#endif
@@ -0,0 +1,552 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "MultiBufferExp.h"
+#include "Division.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+// One digit of all four lanes.
+
+#ifdef __AVX2__
+
+typedef __m256i Vec4;
+
+static inline Vec4 vecLoad( const Int64* from )
+{
+return _mm256_loadu_si256(
+             reinterpret_cast<const __m256i*>( from ));
+}
+
+static inline void vecStore( Int64* to,
+                             const Vec4 from )
+{
+_mm256_storeu_si256(
+             reinterpret_cast<__m256i*>( to ), from );
+}
+
+static inline Vec4 vecZero( void )
+{
+return _mm256_setzero_si256();
+}
+
+static inline Vec4 vecAdd( const Vec4 a,
+                           const Vec4 b )
+{
+return _mm256_add_epi64( a, b );
+}
+
+static inline Vec4 vecSub( const Vec4 a,
+                           const Vec4 b )
+{
+return _mm256_sub_epi64( a, b );
+}
+
+// The low 32 bits of each times the low 32
+// bits of the other.
+static inline Vec4 vecMul( const Vec4 a,
+                           const Vec4 b )
+{
+return _mm256_mul_epu32( a, b );
+}
+
+static inline Vec4 vecLow24( const Vec4 a )
+{
+return _mm256_and_si256( a,
+       _mm256_set1_epi64x( Integer::Int24BitMask ));
+}
+
+static inline Vec4 vecHigh( const Vec4 a )
+{
+return _mm256_srli_epi64( a, 24 );
+}
+
+// 1 if it went negative, or else 0.
+static inline Vec4 vecSign( const Vec4 a )
+{
+return _mm256_srli_epi64( a, 63 );
+}
+
+// Where isOne is 1 it takes ifOne.
+static inline Vec4 vecSelect( const Vec4 isOne,
+                              const Vec4 ifOne,
+                              const Vec4 ifZero )
+{
+const Vec4 mask = _mm256_sub_epi64(
+                      _mm256_setzero_si256(), isOne );
+return _mm256_blendv_epi8( ifZero, ifOne, mask );
+}
+
+#else
+
+// The lanes are written out instead of being
+// a loop so the compiler doesn't have to
+// unroll it.
+
+struct Vec4
+  {
+  Int64 l0;
+  Int64 l1;
+  Int64 l2;
+  Int64 l3;
+  };
+
+static inline Vec4 vecLoad( const Int64* from )
+{
+return { from[0], from[1], from[2], from[3] };
+}
+
+static inline void vecStore( Int64* to,
+                             const Vec4 from )
+{
+to[0] = from.l0;
+to[1] = from.l1;
+to[2] = from.l2;
+to[3] = from.l3;
+}
+
+static inline Vec4 vecZero( void )
+{
+return { 0, 0, 0, 0 };
+}
+
+static inline Vec4 vecAdd( const Vec4 a,
+                           const Vec4 b )
+{
+return { a.l0 + b.l0, a.l1 + b.l1,
+         a.l2 + b.l2, a.l3 + b.l3 };
+}
+
+static inline Vec4 vecSub( const Vec4 a,
+                           const Vec4 b )
+{
+return { a.l0 - b.l0, a.l1 - b.l1,
+         a.l2 - b.l2, a.l3 - b.l3 };
+}
+
+static inline Int64 mul32( const Int64 a,
+                           const Int64 b )
+{
+return (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+}
+
+static inline Vec4 vecMul( const Vec4 a,
+                           const Vec4 b )
+{
+return { mul32( a.l0, b.l0 ), mul32( a.l1, b.l1 ),
+         mul32( a.l2, b.l2 ), mul32( a.l3, b.l3 ) };
+}
+
+static inline Vec4 vecLow24( const Vec4 a )
+{
+const Int64 mask = Integer::Int24BitMask;
+return { a.l0 & mask, a.l1 & mask,
+         a.l2 & mask, a.l3 & mask };
+}
+
+static inline Int64 shiftU( const Int64 a,
+                            const Int32 shiftBy )
+{
+return static_cast<Int64>(
+           static_cast<Uint64>( a ) >> shiftBy );
+}
+
+static inline Vec4 vecHigh( const Vec4 a )
+{
+return { shiftU( a.l0, 24 ), shiftU( a.l1, 24 ),
+         shiftU( a.l2, 24 ), shiftU( a.l3, 24 ) };
+}
+
+static inline Vec4 vecSign( const Vec4 a )
+{
+return { shiftU( a.l0, 63 ), shiftU( a.l1, 63 ),
+         shiftU( a.l2, 63 ), shiftU( a.l3, 63 ) };
+}
+
+static inline Vec4 vecSelect( const Vec4 isOne,
+                              const Vec4 ifOne,
+                              const Vec4 ifZero )
+{
+return { isOne.l0 ? ifOne.l0 : ifZero.l0,
+         isOne.l1 ? ifOne.l1 : ifZero.l1,
+         isOne.l2 ? ifOne.l2 : ifZero.l2,
+         isOne.l3 ? ifOne.l3 : ifZero.l3 };
+}
+
+#endif
+
+
+
+void MultiBufferExp::freeAll( void )
+{
+delete[] modulus;
+delete[] table;
+delete[] accum;
+delete[] diff;
+delete[] x;
+delete[] y;
+
+modulus = nullptr;
+table = nullptr;
+accum = nullptr;
+diff = nullptr;
+x = nullptr;
+y = nullptr;
+digitCount = 0;
+digitsAllocated = 0;
+}
+
+
+
+void MultiBufferExp::setDigitCount(
+                              const Int32 setTo )
+{
+digitCount = setTo;
+if( setTo <= digitsAllocated )
+  return;
+
+freeAll();
+digitCount = setTo;
+digitsAllocated = setTo;
+
+const Int32 size = setTo * Lanes;
+modulus = new Int64[size];
+table = new Int64[size * TableSize];
+accum = new Int64[size * 2];
+diff = new Int64[size];
+x = new Int64[size];
+y = new Int64[size];
+}
+
+
+
+// -1 / low mod 2^24, for the Montgomery
+// reduction.
+
+Int64 MultiBufferExp::getN0Inv( const Int64 low )
+{
+return (0x1000000 - Division::inverseMod24( low )) &
+                         Integer::Int24BitMask;
+}
+
+
+
+void MultiBufferExp::toLane( const Integer& from,
+                             const Int32 lane,
+                             Int64* to ) const
+{
+const Int32 last = from.getIndex();
+for( Int32 count = 0; count < digitCount;
+                                      count++ )
+  {
+  Int64 digit = 0;
+  if( count <= last )
+    digit = from.getD( count );
+
+  to[(count * Lanes) + lane] = digit;
+  }
+}
+
+
+
+void MultiBufferExp::fromLane( const Int64* from,
+                               const Int32 lane,
+                               Integer& to ) const
+{
+// Leave out the zeros at the top.
+Int32 top = digitCount - 1;
+while( (top > 0) &&
+       (from[(top * Lanes) + lane] == 0) )
+  top--;
+
+to.setToZero();
+to.setIndex( top );
+for( Int32 count = 0; count <= top; count++ )
+  to.setD( count, from[(count * Lanes) + lane] );
+
+}
+
+
+
+void MultiBufferExp::montMultiply( Int64* result,
+                                   const Int64* a,
+                                   const Int64* b )
+{
+const Int32 n = digitCount;
+const Vec4 n0 = vecLoad( n0Inv );
+
+for( Int32 count = 0; count < (n * 2); count++ )
+  vecStore( &accum[count * Lanes], vecZero());
+
+// accum[i] through accum[i + n] is the
+// running total after step i, with the
+// digits not carried yet.  Each accum digit
+// gets at most 2n products of 48 bits, so
+// it can't go over 64 bits.
+for( Int32 i = 0; i < n; i++ )
+  {
+  const Vec4 bDigit = vecLoad( &b[i * Lanes] );
+  Int64* t = &accum[i * Lanes];
+  for( Int32 j = 0; j < n; j++ )
+    {
+    Vec4 sum = vecLoad( &t[j * Lanes] );
+    sum = vecAdd( sum, vecMul( vecLoad(
+                       &a[j * Lanes] ), bDigit ));
+    vecStore( &t[j * Lanes], sum );
+    }
+
+  // This makes the bottom digit zero.
+  const Vec4 m = vecLow24( vecMul( vecLow24(
+                   vecLoad( t )), n0 ));
+  for( Int32 j = 0; j < n; j++ )
+    {
+    Vec4 sum = vecLoad( &t[j * Lanes] );
+    sum = vecAdd( sum, vecMul( vecLoad(
+                  &modulus[j * Lanes] ), m ));
+    vecStore( &t[j * Lanes], sum );
+    }
+
+  const Vec4 carry = vecHigh( vecLoad( t ));
+  vecStore( &t[Lanes], vecAdd( vecLoad(
+                           &t[Lanes] ), carry ));
+  }
+
+// The total is accum[n] and up, and it is
+// less than 2 * modulus.  Do the carries,
+// and then subtract the modulus if it is
+// not too big.
+const Int64* top = &accum[n * Lanes];
+Vec4 carry = vecZero();
+Vec4 borrow = vecZero();
+for( Int32 j = 0; j < n; j++ )
+  {
+  const Vec4 sum = vecAdd( vecLoad(
+                       &top[j * Lanes] ), carry );
+  const Vec4 digit = vecLow24( sum );
+  carry = vecHigh( sum );
+  vecStore( &result[j * Lanes], digit );
+
+  const Vec4 sub = vecSub( vecSub( digit,
+                     vecLoad( &modulus[j * Lanes] )),
+                     borrow );
+  borrow = vecSign( sub );
+  vecStore( &diff[j * Lanes], vecLow24( sub ));
+  }
+
+// If the carry out of the top is less than
+// the borrow then it was less than the
+// modulus.
+const Vec4 tooSmall = vecSign( vecSub( carry,
+                                       borrow ));
+for( Int32 j = 0; j < n; j++ )
+  {
+  const Vec4 digit = vecSelect( tooSmall,
+                       vecLoad( &result[j * Lanes] ),
+                       vecLoad( &diff[j * Lanes] ));
+  vecStore( &result[j * Lanes], digit );
+  }
+}
+
+
+
+void MultiBufferExp::toPower( Integer* results,
+                              const Integer* bases,
+                              const Integer* exponents,
+                              const Integer* moduli,
+                              const Int32 howMany,
+                              IntegerMath& intMath )
+{
+if( (howMany < 1) || (howMany > Lanes) )
+  throw "MultiBufferExp howMany range.";
+
+// Lanes with an even modulus or a special
+// case, and the ones past howMany, get a
+// copy of a lane that is being used, and
+// the answer is thrown away.
+bool useLane[Lanes];
+Int32 firstUsed = -1;
+Int32 maxIndex = 0;
+Int32 maxExpIndex = 0;
+for( Int32 lane = 0; lane < Lanes; lane++ )
+  {
+  useLane[lane] = false;
+  if( lane >= howMany )
+    continue;
+
+  if( exponents[lane].getNegative() ||
+      bases[lane].getNegative() ||
+      moduli[lane].getNegative())
+    throw "MultiBufferExp negative.";
+
+  if( moduli[lane].isZero())
+    throw "MultiBufferExp modulus is zero.";
+
+  // The same special cases as Mod::toPower(),
+  // in the same order.
+  if( bases[lane].isZero() ||
+      bases[lane].isEqual( moduli[lane] ))
+    {
+    results[lane].setToZero();
+    continue;
+    }
+
+  if( exponents[lane].isZero())
+    {
+    results[lane].setToOne();
+    continue;
+    }
+
+  if( (moduli[lane].getD( 0 ) & 1) == 0 )
+    {
+    results[lane].copy( bases[lane] );
+    mod.toPower( results[lane], exponents[lane],
+                 moduli[lane], intMath );
+    continue;
+    }
+
+  useLane[lane] = true;
+  if( firstUsed < 0 )
+    firstUsed = lane;
+
+  if( maxIndex < moduli[lane].getIndex())
+    maxIndex = moduli[lane].getIndex();
+
+  if( maxExpIndex < exponents[lane].getIndex())
+    maxExpIndex = exponents[lane].getIndex();
+
+  }
+
+if( firstUsed < 0 )
+  return;
+
+// R^2 has to fit in an Integer.
+const Int32 n = maxIndex + 1;
+if( ((n * 2) + 1) >= IntConst::DigitArraySize )
+  throw "MultiBufferExp modulus is too big.";
+
+setDigitCount( n );
+
+Int32 laneFrom[Lanes];
+for( Int32 lane = 0; lane < Lanes; lane++ )
+  laneFrom[lane] = useLane[lane] ? lane :
+                                   firstUsed;
+
+// x gets R^2 mod m, and y gets the base mod m.
+Integer rSquared;
+Integer reduced;
+Integer baseReduced[Lanes];
+for( Int32 lane = 0; lane < Lanes; lane++ )
+  {
+  const Int32 from = laneFrom[lane];
+  const Integer& m = moduli[from];
+  toLane( m, lane, modulus );
+  n0Inv[lane] = getN0Inv( m.getD( 0 ));
+
+  rSquared.setToZero();
+  rSquared.setIndex( n * 2 );
+  for( Int32 count = 0; count < (n * 2); count++ )
+    rSquared.setD( count, 0 );
+
+  rSquared.setD( n * 2, 1 );
+  Division::remainderOnly( rSquared, m, reduced,
+                                     intMath );
+  toLane( reduced, lane, x );
+
+  Division::remainderOnly( bases[from], m,
+                           baseReduced[lane],
+                           intMath );
+  toLane( baseReduced[lane], lane, y );
+  }
+
+// table[power] is base^power times R.
+// table[0] is R mod m, which is one times R.
+montMultiply( &table[n * Lanes], y, x );
+for( Int32 count = 0; count < (n * Lanes);
+                                      count++ )
+  y[count] = 0;
+
+for( Int32 lane = 0; lane < Lanes; lane++ )
+  y[lane] = 1;
+
+montMultiply( table, y, x );
+for( Int32 power = 2; power < TableSize; power++ )
+  montMultiply( &table[power * n * Lanes],
+                &table[(power - 1) * n * Lanes],
+                &table[n * Lanes] );
+
+// x is the running result.
+for( Int32 count = 0; count < (n * Lanes);
+                                      count++ )
+  x[count] = table[count];
+
+for( Int32 digit = maxExpIndex; digit >= 0;
+                                       digit-- )
+  {
+  for( Int32 shiftBy = 24 - WindowBits;
+                   shiftBy >= 0;
+                   shiftBy -= WindowBits )
+    {
+    for( Int32 count = 0; count < WindowBits;
+                                       count++ )
+      montMultiply( x, x, x );
+
+    // Each lane picks its own table entry.
+    for( Int32 lane = 0; lane < Lanes; lane++ )
+      {
+      const Integer& exponent = exponents[
+                                laneFrom[lane]];
+      Int32 window = 0;
+      if( digit <= exponent.getIndex())
+        window = static_cast<Int32>(
+                 (exponent.getD( digit ) >> shiftBy)
+                 & (TableSize - 1) );
+
+      const Int64* power = &table[
+                             window * n * Lanes];
+      for( Int32 count = 0; count < n; count++ )
+        y[(count * Lanes) + lane] =
+                       power[(count * Lanes) + lane];
+
+      }
+
+    montMultiply( x, x, y );
+    }
+  }
+
+// Times one is times R^-1, which takes it
+// back out of Montgomery form.
+for( Int32 count = 0; count < (n * Lanes);
+                                      count++ )
+  y[count] = 0;
+
+for( Int32 lane = 0; lane < Lanes; lane++ )
+  y[lane] = 1;
+
+montMultiply( x, x, y );
+
+for( Int32 lane = 0; lane < howMany; lane++ )
+  {
+  if( useLane[lane] )
+    fromLane( x, lane, results[lane] );
+
+  }
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
@@ -0,0 +1,124 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// This does Lanes separate modular powers at
+// the same time, one in each lane, all in
+// lockstep.  Lane k of a number is at
+// [(digit * Lanes) + k], so one digit of
+// all of the lanes is next to each other in
+// memory, and with AVX2 that is one
+// register.  A 24 bit digit times a 24 bit
+// digit fits in the 32 by 32 to 64 bit
+// multiply of _mm256_mul_epu32(), and there
+// is enough room left over in 64 bits that
+// the carries can wait until the end of a
+// multiply.  Without AVX2 it is the same
+// thing with a loop over the lanes.
+
+// The multiplies are Montgomery
+// multiplication, the CIOS way from Koc,
+// Acar and Kaliski, "Analyzing and Comparing
+// Montgomery Multiplication Algorithms",
+// 1996.  That needs an odd modulus, so a
+// lane with an even modulus is done with
+// Mod::toPower() instead.
+
+// The exponent is done with fixed windows
+// and every window does a multiply, even by
+// one, so the lanes never have to branch
+// differently.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "Mod.h"
+
+
+
+class MultiBufferExp
+  {
+  public:
+  static const Int32 Lanes = 4;
+
+  private:
+  bool testForCopy = false;
+  static const Int32 WindowBits = 4;
+  static const Int32 TableSize = 1 << WindowBits;
+
+  // How many digits each lane has.
+  Int32 digitCount = 0;
+  Int32 digitsAllocated = 0;
+
+  Int64* modulus = nullptr;
+  Int64* table = nullptr;
+  Int64* accum = nullptr;
+  Int64* diff = nullptr;
+  Int64* x = nullptr;
+  Int64* y = nullptr;
+
+  // -modulus^-1 mod 2^24 for each lane.
+  Int64 n0Inv[Lanes] = { 0 };
+
+  Mod mod;
+
+  void freeAll( void );
+  void setDigitCount( const Int32 setTo );
+  static Int64 getN0Inv( const Int64 low );
+  void toLane( const Integer& from,
+               const Int32 lane,
+               Int64* to ) const;
+  void fromLane( const Int64* from,
+                 const Int32 lane,
+                 Integer& to ) const;
+
+  // result = a * b / R mod modulus, where R is
+  // 2^(24 * digitCount).  result can be the
+  // same as a or b.
+  void montMultiply( Int64* result,
+                     const Int64* a,
+                     const Int64* b );
+
+  public:
+  MultiBufferExp( void )
+    {
+    }
+
+  MultiBufferExp( const MultiBufferExp& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "MultiBufferExp copy constructor.";
+    }
+
+  ~MultiBufferExp( void )
+    {
+    freeAll();
+    }
+
+  // results[count] = bases[count] to the
+  // power exponents[count], mod
+  // moduli[count], the same as Mod::toPower()
+  // would give.  howMany is 1 to Lanes.  They
+  // go fastest if the moduli are all about
+  // the same size.
+  void toPower( Integer* results,
+                const Integer* bases,
+                const Integer* exponents,
+                const Integer* moduli,
+                const Int32 howMany,
+                IntegerMath& intMath );
+
+  };
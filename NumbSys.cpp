@@ -59,22 +59,20 @@ base2.setFromLong48(
                 Integer::Int24BitMask + 1 );
 
 Integer baseValue;
-Integer quotient;
-Integer remainder;
 
 baseValue.setToOne();
 
 for( Int32 count = 0; count < last; count++ )
   {
-  Division::divide( baseValue, currentBase,
-                    quotient, remainder,
-                    intMath );
-
-  intAr[count].copy( remainder );
+  // The quotient is never used here.
+  Division::remainderOnly( baseValue,
+                           currentBase,
+                           intAr[count],
+                           intMath );
 
   // Done at the bottom for the next round of
   // the loop.
-  baseValue.copy( remainder );
+  baseValue.copy( intAr[count] );
   intMath.multiply( baseValue, base2 );
   }
 
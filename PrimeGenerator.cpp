@@ -0,0 +1,256 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "PrimeGenerator.h"
+#include "IntegerMath.h"
+#include "BailliePSW.h"
+#include "PrimeSearch.h"
+#include "../CppBase/Casting.h"
+
+#include <thread>
+#include <memory>
+
+
+
+PrimeGenerator::PrimeGenerator( void )
+{
+nextChunk.store( 0 );
+bestOffset.store( noneFound );
+candidatesTested.store( 0 );
+cancelled.store( false );
+workerError.store( nullptr );
+}
+
+
+
+// Sebastiano Vigna's SplitMix64.
+
+Uint64 PrimeGenerator::splitMix64( Uint64& state )
+{
+state += 0x9E3779B97F4A7C15ULL;
+Uint64 z = state;
+z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+return z ^ (z >> 31);
+}
+
+
+
+void PrimeGenerator::setStart(
+                        const Int32 setToIndex,
+                        const Uint64 seed )
+{
+Uint64 state = seed;
+start.setToZero();
+start.setIndex( setToIndex );
+for( Int32 count = 0; count <= setToIndex;
+                                      count++ )
+  {
+  const Uint64 rand = splitMix64( state );
+  start.setD( count, Casting::u64ToI32(
+                 rand & Integer::Int24BitMask ));
+  }
+
+// The top bit is set so it's the right size,
+// and it's odd.
+start.setD( setToIndex,
+            start.getD( setToIndex ) | 0x800000 );
+start.setD( 0, start.getD( 0 ) | 1 );
+}
+
+
+
+void PrimeGenerator::setBest( const Int64 offset )
+{
+Int64 best = bestOffset.load();
+while( offset < best )
+  {
+  if( bestOffset.compare_exchange_weak( best,
+                                     offset ))
+    break;
+
+  }
+}
+
+
+
+void PrimeGenerator::worker(
+                       const SPrimes& sPrimes )
+{
+try
+{
+testChunks( sPrimes );
+}
+catch( const char* in )
+  {
+  workerError.store( in );
+  cancelled.store( true );
+  }
+catch( ... )
+  {
+  workerError.store(
+         "PrimeGenerator worker exception." );
+  cancelled.store( true );
+  }
+}
+
+
+
+void PrimeGenerator::testChunks(
+                       const SPrimes& sPrimes )
+{
+// These are big, so they go on the heap
+// instead of the thread's stack.  They get
+// deleted if anything in here throws.
+std::unique_ptr<IntegerMath> intMath(
+                           new IntegerMath );
+std::unique_ptr<BailliePSW> bpsw(
+                           new BailliePSW );
+std::unique_ptr<PrimeSearch> search(
+                           new PrimeSearch );
+std::unique_ptr<Integer> candidate(
+                           new Integer );
+
+// The start is only divided by the sieve
+// primes once for each thread.  Then each
+// chunk is one interval of the sieve, and
+// skipTo() gets there by adding to the
+// remainders.
+search->setSieveSize( Casting::i64ToI32(
+                               chunkSize ));
+search->setStart( start, 2, sPrimes );
+
+while( !cancelled.load() )
+  {
+  const Int64 chunk = nextChunk.fetch_add( 1 );
+  if( chunk >= maxChunks )
+    break;
+
+  const Int64 firstOffset = chunk * chunkSize;
+  if( firstOffset > bestOffset.load() )
+    break;
+
+  search->skipTo( firstOffset );
+
+  while( !cancelled.load() )
+    {
+    search->nextCandidate( *candidate );
+    const Int64 offset = search->getOffset();
+    if( offset >= (firstOffset + chunkSize) )
+      break;
+
+    if( offset > bestOffset.load() )
+      break;
+
+    candidatesTested.fetch_add( 1 );
+    if( bpsw->isProbablePrime( *candidate,
+                               sPrimes,
+                               *intMath ))
+      {
+      setBest( offset );
+      break;
+      }
+    }
+  }
+}
+
+
+
+bool PrimeGenerator::makePrime(
+                      Integer& result,
+                      const Int32 setToIndex,
+                      const Uint64 seed,
+                      const Int32 threadCount,
+                      const SPrimes& sPrimes )
+{
+if( (threadCount < 1) || (threadCount > 256) )
+  throw "PrimeGenerator threadCount range.";
+
+// If it was small enough a candidate could
+// be one of the sieve primes, and that
+// would get skipped.
+if( setToIndex < 2 )
+  throw "PrimeGenerator setToIndex is too small.";
+
+// cancelled is not cleared here.  It is
+// cleared when a run is over, so a cancel()
+// from just before this started still
+// stops it.
+setStart( setToIndex, seed );
+nextChunk.store( 0 );
+bestOffset.store( noneFound );
+candidatesTested.store( 0 );
+workerError.store( nullptr );
+
+std::thread* threads = new std::thread[
+                                  threadCount];
+try
+{
+for( Int32 count = 0; count < threadCount;
+                                      count++ )
+  threads[count] = std::thread(
+                      &PrimeGenerator::worker,
+                      this, std::cref( sPrimes ));
+
+}
+catch( ... )
+  {
+  // A thread couldn't be started.  The ones
+  // that were started use this object and
+  // sPrimes, so they have to be stopped
+  // before this returns.
+  cancelled.store( true );
+  for( Int32 count = 0; count < threadCount;
+                                      count++ )
+    {
+    if( threads[count].joinable())
+      threads[count].join();
+
+    }
+
+  delete[] threads;
+  cancelled.store( false );
+  throw;
+  }
+
+for( Int32 count = 0; count < threadCount;
+                                      count++ )
+  threads[count].join();
+
+delete[] threads;
+
+const bool wasCancelled = cancelled.exchange(
+                                       false );
+
+const char* error = workerError.load();
+if( error != nullptr )
+  throw error;
+
+const Int64 best = bestOffset.load();
+if( best == noneFound )
+  {
+  if( wasCancelled )
+    return false;
+
+  throw "PrimeGenerator didn't find a prime.";
+  }
+
+// If it was cancelled after a prime was
+// found, some smaller k might not have been
+// tested, so it might not be the same
+// answer.
+if( wasCancelled )
+  return false;
+
+result.copy( start );
+result.addLong48( best * 2 );
+return true;
+}
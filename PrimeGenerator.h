@@ -0,0 +1,104 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// This finds a prime with more than one
+// thread.  The start number comes from a
+// seed, so the same seed always gives the
+// same start.  The candidates are
+// start + 2k, and the threads take chunks
+// of k values from a shared counter.  Each
+// thread has its own IntegerMath, Mod and
+// PrimeSearch.  SPrimes is only read, so
+// they all share it.
+
+// The answer is the prime with the smallest
+// k, which is what one thread would find by
+// going up from the start.  So the number of
+// threads doesn't change the answer.  When
+// a thread finds a prime the other threads
+// stop at any k bigger than that, but they
+// still finish the smaller ones.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "../CryptoBase/SPrimes.h"
+
+#include <atomic>
+
+
+
+class PrimeGenerator
+  {
+  private:
+  bool testForCopy = false;
+
+  // How many k values are in a chunk.
+  static const Int64 chunkSize = 256;
+  static const Int64 maxChunks = 1024 * 64;
+  static const Int64 noneFound = 0x7FFFFFFFFFFFFFFFLL;
+
+  Integer start;
+  std::atomic<Int64> nextChunk;
+  std::atomic<Int64> bestOffset;
+  std::atomic<Int64> candidatesTested;
+  std::atomic<bool> cancelled;
+  std::atomic<const char*> workerError;
+
+  static Uint64 splitMix64( Uint64& state );
+  void setStart( const Int32 setToIndex,
+                 const Uint64 seed );
+
+  void worker( const SPrimes& sPrimes );
+  void testChunks( const SPrimes& sPrimes );
+  void setBest( const Int64 offset );
+
+  public:
+  PrimeGenerator( void );
+
+  PrimeGenerator( const PrimeGenerator& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "PrimeGenerator copy constructor.";
+    }
+
+  ~PrimeGenerator( void )
+    {
+    }
+
+  // This makes a prime with setToIndex + 1
+  // digits and the top bit set.  It returns
+  // false if cancel() was called.
+  bool makePrime( Integer& result,
+                  const Int32 setToIndex,
+                  const Uint64 seed,
+                  const Int32 threadCount,
+                  const SPrimes& sPrimes );
+
+  // This can be called from another thread.
+  // If no makePrime() is running, the next
+  // one returns false right away.
+  inline void cancel( void )
+    {
+    cancelled.store( true );
+    }
+
+  inline Int64 getCandidatesTested( void ) const
+    {
+    return candidatesTested.load();
+    }
+
+  };
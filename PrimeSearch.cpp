@@ -0,0 +1,340 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "PrimeSearch.h"
+#include "IntegerMath.h"
+#include "Recip24.h"
+#include "../CppBase/Casting.h"
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+void PrimeSearch::freeAll( void )
+{
+delete[] primes;
+delete[] residues;
+delete[] startResidues;
+delete[] stepMod;
+delete[] stepInverse;
+delete[] sieveBits;
+
+primes = nullptr;
+residues = nullptr;
+startResidues = nullptr;
+stepMod = nullptr;
+stepInverse = nullptr;
+sieveBits = nullptr;
+primeCount = 0;
+}
+
+
+
+// Extended Euclid for small numbers.
+// x is not zero and is less than prime.
+
+Int64 PrimeSearch::inverseSmall( const Int64 x,
+                                 const Int64 prime )
+{
+Int64 oldR = prime;
+Int64 r = x;
+Int64 oldT = 0;
+Int64 t = 1;
+while( r != 0 )
+  {
+  const Int64 q = oldR / r;
+  Int64 temp = oldR - (q * r);
+  oldR = r;
+  r = temp;
+
+  temp = oldT - (q * t);
+  oldT = t;
+  t = temp;
+  }
+
+if( oldR != 1 )
+  throw "PrimeSearch.inverseSmall() no inverse.";
+
+if( oldT < 0 )
+  oldT += prime;
+
+return oldT;
+}
+
+
+
+void PrimeSearch::setSieveSize( const Int32 setTo )
+{
+if( (setTo < 32) || ((setTo & 31) != 0) )
+  throw "PrimeSearch.setSieveSize() size.";
+
+sieveSize = setTo;
+if( sieveBits == nullptr )
+  return;
+
+// It was already started, so the bits have
+// to be the new size, and it sieves again
+// from the next candidate it would have
+// looked at.
+delete[] sieveBits;
+sieveBits = new Uint32[sieveSize / 32];
+skipTo( sieveBase + sieveWhere );
+}
+
+
+
+void PrimeSearch::setSieveSafe( const bool setTo )
+{
+sieveSafe = setTo;
+if( sieveBits == nullptr )
+  return;
+
+checkCandidates();
+skipTo( sieveBase + sieveWhere );
+}
+
+
+
+// If a prime divides the step, the step
+// doesn't change the residue for it.  Then
+// if that prime divides the start it
+// divides every candidate, and
+// sieveInterval() would mark all of them.
+// nextCandidate() would go through a
+// thousand intervals before it gave up.
+
+void PrimeSearch::checkCandidates( void )
+{
+for( Int32 count = 0; count < primeCount;
+                                      count++ )
+  {
+  if( stepInverse[count] != 0 )
+    continue;
+
+  const Int64 prime = primes[count];
+  const Int64 residue = startResidues[count];
+  if( residue == 0 )
+    {
+    freeAll();
+    throw "PrimeSearch no candidates.";
+    }
+
+  if( sieveSafe && (prime != 2) &&
+      (residue == ((prime - 1) / 2)) )
+    {
+    freeAll();
+    throw "PrimeSearch no safe candidates.";
+    }
+  }
+}
+
+
+
+void PrimeSearch::setStart(
+                     const Integer& setTo,
+                     const Int64 setStep,
+                     const SPrimes& sPrimes )
+{
+if( setTo.getNegative() )
+  throw "PrimeSearch.setStart() negative.";
+
+if( (setStep <= 0) || ((setStep >> 23) != 0) )
+  throw "PrimeSearch.setStart() step range.";
+
+freeAll();
+start.copy( setTo );
+step = setStep;
+
+// The residues are found modLanes primes at
+// a time, so pad the arrays out to that.
+const Int32 lanes = IntegerMath::modLanes;
+primeCount = SPrimes::primesArraySize;
+const Int32 padded = ((primeCount + lanes - 1) /
+                               lanes) * lanes;
+
+primes = new Int64[padded];
+residues = new Int64[padded];
+startResidues = new Int64[primeCount];
+stepMod = new Int64[primeCount];
+stepInverse = new Int64[primeCount];
+sieveBits = new Uint32[sieveSize / 32];
+
+Recip24* recips = new Recip24[padded];
+for( Int32 count = 0; count < padded; count++ )
+  {
+  Int32 where = count;
+  if( where >= primeCount )
+    where = 0;
+
+  primes[count] = sPrimes.getPrimeAt( where );
+  recips[count].setDivisor( primes[count] );
+  }
+
+// This is the only time the big number
+// gets divided.
+for( Int32 count = 0; count < padded;
+                               count += lanes )
+  IntegerMath::getMod24Lanes( start,
+                              &recips[count],
+                              &residues[count] );
+
+delete[] recips;
+
+for( Int32 count = 0; count < primeCount;
+                                      count++ )
+  {
+  const Int64 prime = primes[count];
+  startResidues[count] = residues[count];
+  stepMod[count] = step % prime;
+  if( stepMod[count] == 0 )
+    stepInverse[count] = 0;
+  else
+    stepInverse[count] = inverseSmall(
+                          stepMod[count], prime );
+
+  }
+
+checkCandidates();
+sieveBase = 0;
+sieveInterval();
+}
+
+
+
+// This marks the candidates in the interval
+// starting at sieveBase, then moves the
+// residues up to the start of the next
+// interval.
+
+void PrimeSearch::sieveInterval( void )
+{
+const Int32 words = sieveSize / 32;
+for( Int32 count = 0; count < words; count++ )
+  sieveBits[count] = 0;
+
+for( Int32 count = 0; count < primeCount;
+                                      count++ )
+  {
+  const Int64 prime = primes[count];
+  const Int64 residue = residues[count];
+
+  // 2c + 1 = 0 mod prime when
+  // c = (prime - 1) / 2.  That's not for
+  // 2, since 2c + 1 is always odd.
+  const bool doSafe = sieveSafe && (prime != 2);
+  const Int64 halfPrime = (prime - 1) / 2;
+
+  // The step doesn't change the residue.
+  // setStart() already checked that this
+  // prime doesn't divide every candidate, so
+  // it divides none of them.
+  if( stepInverse[count] == 0 )
+    continue;
+
+  // residue + (j * stepMod) = 0 mod prime.
+  Int64 j = ((prime - residue) *
+               stepInverse[count]) % prime;
+  for( ; j < sieveSize; j += prime )
+    {
+    const Int32 bit = Casting::i64ToI32( j );
+    sieveBits[bit >> 5] |= 1U << (bit & 31);
+    }
+
+  if( doSafe )
+    {
+    j = (((halfPrime - residue) + prime) *
+                 stepInverse[count]) % prime;
+    for( ; j < sieveSize; j += prime )
+      {
+      const Int32 bit = Casting::i64ToI32( j );
+      sieveBits[bit >> 5] |= 1U << (bit & 31);
+      }
+    }
+
+  residues[count] = (residue + (sieveSize *
+                       stepMod[count])) % prime;
+  }
+
+sieveWhere = 0;
+sieveIsDone = false;
+}
+
+
+
+void PrimeSearch::skipTo( const Int64 offset )
+{
+if( primeCount == 0 )
+  throw "PrimeSearch.skipTo() no start.";
+
+if( (offset < 0) || ((offset >> 40) != 0) )
+  throw "PrimeSearch.skipTo() offset range.";
+
+for( Int32 count = 0; count < primeCount;
+                                      count++ )
+  {
+  const Int64 prime = primes[count];
+  residues[count] = (startResidues[count] +
+                     ((offset % prime) *
+                      stepMod[count])) % prime;
+  }
+
+sieveBase = offset;
+sieveInterval();
+}
+
+
+
+void PrimeSearch::nextCandidate(
+                            Integer& candidate )
+{
+if( primeCount == 0 )
+  throw "PrimeSearch.nextCandidate() no start.";
+
+// About eight million candidates, whatever
+// the size of the interval is.
+const Int32 maxTries = (1024 * 8 * 1000) /
+                                   sieveSize;
+for( Int32 tries = 0; tries < maxTries; tries++ )
+  {
+  if( sieveIsDone )
+    {
+    sieveBase += sieveSize;
+    sieveInterval();
+    }
+
+  while( sieveWhere < sieveSize )
+    {
+    const Int32 bit = sieveWhere;
+    sieveWhere++;
+    if( (sieveBits[bit >> 5] &
+                  (1U << (bit & 31))) != 0 )
+      continue;
+
+    const Int64 offset = sieveBase + bit;
+    const Int64 toAdd = offset * step;
+    if( (toAdd >> 47) != 0 )
+      throw "PrimeSearch offset is too big.";
+
+    candidate.copy( start );
+    candidate.addLong48( toAdd );
+    return;
+    }
+
+  sieveIsDone = true;
+  }
+
+throw "PrimeSearch found no candidates.";
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
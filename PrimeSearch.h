@@ -0,0 +1,138 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// For searching for a prime starting at some
+// number, like from makeRandomOdd(), and
+// going up by a step, like 2.
+// The remainders of the start number for
+// each prime in SPrimes are found once.
+// After that it only adds the step to those
+// remainders, so it never has to divide the
+// big number again.  It sieves a whole
+// interval of candidates at a time with a
+// bit array.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "../CryptoBase/SPrimes.h"
+
+
+
+class PrimeSearch
+  {
+  private:
+  bool testForCopy = false;
+
+  // How many candidates are in one interval.
+  // This is a multiple of 32.
+  Int32 sieveSize = 1024 * 8;
+
+  Integer start;
+  Int64 step = 2;
+
+  Int32 primeCount = 0;
+  Int64* primes = nullptr;
+
+  // The remainder for each prime of the
+  // candidate at sieveBase.
+  Int64* residues = nullptr;
+
+  // The remainder for each prime of start,
+  // so skipTo() can go anywhere without
+  // dividing the big number again.
+  Int64* startResidues = nullptr;
+
+  Int64* stepMod = nullptr;
+
+  // The inverse of stepMod mod the prime,
+  // or zero if the prime divides step.
+  Int64* stepInverse = nullptr;
+
+  // A bit is set if a prime divides that
+  // candidate.
+  Uint32* sieveBits = nullptr;
+
+  // The candidate at bit zero is
+  // start + (sieveBase * step).
+  Int64 sieveBase = 0;
+  Int32 sieveWhere = 0;
+  bool sieveIsDone = false;
+
+  // For safe primes.  Also take out
+  // candidates c where a prime divides
+  // 2c + 1.
+  bool sieveSafe = false;
+
+  static Int64 inverseSmall( const Int64 x,
+                             const Int64 prime );
+  void freeAll( void );
+  void checkCandidates( void );
+  void sieveInterval( void );
+
+  public:
+  PrimeSearch( void )
+    {
+    }
+
+  PrimeSearch( const PrimeSearch& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "PrimeSearch copy constructor.";
+    }
+
+  ~PrimeSearch( void )
+    {
+    freeAll();
+    }
+
+  // These are usually set before setStart().
+  // If they are set after it, it sieves
+  // again starting at the next candidate.
+  void setSieveSafe( const bool setTo );
+
+  // A smaller interval is better if only a
+  // few candidates at a time are used, like
+  // with skipTo().
+  void setSieveSize( const Int32 setTo );
+
+  void setStart( const Integer& setTo,
+                 const Int64 setStep,
+                 const SPrimes& sPrimes );
+
+  // This sets candidate to the next number
+  // that no prime in SPrimes divides.
+  // Like isDivisibleBySmallPrime(), if the
+  // start is small a candidate could be one
+  // of those primes, and it would get
+  // skipped.
+  void nextCandidate( Integer& candidate );
+
+  // The next candidate after this is the
+  // first one at or after
+  // start + (offset * step).  It only has to
+  // add to the remainders, so it's a lot
+  // faster than another setStart().
+  void skipTo( const Int64 offset );
+
+  // The last candidate is
+  // start + (getOffset() * step).
+  inline Int64 getOffset( void ) const
+    {
+    return sieveBase + sieveWhere - 1;
+    }
+
+  };
@@ -0,0 +1,313 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "PrimorialScreen.h"
+#include "Division.h"
+#include "../CppBase/Casting.h"
+
+#include <bit>
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+void PrimorialScreen::freeAll( void )
+{
+delete[] blockProd;
+delete[] blockNorm;
+delete[] blockRecip;
+delete[] blockShift;
+delete[] blockStart;
+delete[] blockEnd;
+delete[] primes;
+
+blockProd = nullptr;
+blockNorm = nullptr;
+blockRecip = nullptr;
+blockShift = nullptr;
+blockStart = nullptr;
+blockEnd = nullptr;
+primes = nullptr;
+blockCount = 0;
+blockArraySize = 0;
+}
+
+
+
+void PrimorialScreen::setup(
+                        const SPrimes& sPrimes )
+{
+freeAll();
+
+const Int32 last = SPrimes::primesArraySize;
+primes = new Int64[last];
+for( Int32 count = 0; count < last; count++ )
+  primes[count] = sPrimes.getPrimeAt( count );
+
+// There can't be more blocks than primes.
+// The 2 at index 0 is left out since the
+// caller checks for even numbers.
+blockArraySize = last + blockLanes;
+blockProd = new Int64[blockArraySize];
+blockNorm = new Int64[blockArraySize];
+blockRecip = new Int64[blockArraySize];
+blockShift = new Int32[blockArraySize];
+blockStart = new Int32[blockArraySize];
+blockEnd = new Int32[blockArraySize];
+
+Int32 where = 1;
+while( where < last )
+  {
+  Int64 prod = primes[where];
+  blockStart[blockCount] = where;
+  where++;
+
+  // prod * prime could overflow, so check
+  // it by dividing first.
+  while( where < last )
+    {
+    if( prod > (Int48BitMask / primes[where]) )
+      break;
+
+    prod *= primes[where];
+    where++;
+    }
+
+  blockEnd[blockCount] = where;
+  blockProd[blockCount] = prod;
+  blockCount++;
+  }
+
+// Pad it out to a multiple of blockLanes
+// with copies of the first block.
+Int32 padded = ((blockCount + blockLanes - 1) /
+                      blockLanes) * blockLanes;
+for( Int32 count = blockCount; count < padded;
+                                      count++ )
+  {
+  blockProd[count] = blockProd[0];
+  blockStart[count] = blockStart[0];
+  blockEnd[count] = blockEnd[0];
+  }
+
+for( Int32 count = 0; count < padded; count++ )
+  {
+  Int32 shiftBy = 0;
+  Int64 norm = blockProd[count];
+  while( (norm & 0x800000000000LL) == 0 )
+    {
+    norm <<= 1;
+    shiftBy++;
+    }
+
+  blockShift[count] = shiftBy;
+  blockNorm[count] = norm;
+  blockRecip[count] = makeRecip( norm );
+  }
+}
+
+
+
+// floor((B^3 - 1) / norm) - B.
+// B^3 is 2^72, which doesn't fit in an Int64,
+// so this is done one bit at a time.  It's
+// only done once for each block.
+
+Int64 PrimorialScreen::makeRecip(
+                             const Int64 norm )
+{
+Int64 quotient = 0;
+Int64 remainder = 0;
+for( Int32 bit = 71; bit >= 0; bit-- )
+  {
+  remainder = (remainder << 1) | 1;
+  quotient <<= 1;
+  if( remainder >= norm )
+    {
+    remainder -= norm;
+    quotient |= 1;
+    }
+  }
+
+return quotient - (Integer::Int24BitMask + 1);
+}
+
+
+
+// Binary gcd where y is odd, which the block
+// products always are.  It counts the
+// trailing zeros all at once instead of
+// shifting them out one bit at a time.
+
+Int64 PrimorialScreen::gcd64( Int64 x,
+                              const Int64 y )
+{
+if( x == 0 )
+  return y;
+
+// Both are positive and less than 2^48.
+Int64 odd = y;
+Int64 other = x;
+while( other != 0 )
+  {
+  other >>= std::countr_zero(
+                 static_cast<Uint64>( other ));
+  if( other < odd )
+    {
+    Int64 temp = odd;
+    odd = other;
+    other = temp;
+    }
+
+  other -= odd;
+  }
+
+return odd;
+}
+
+
+
+// The remainders for blockLanes blocks,
+// starting at first, in one pass through
+// the digits.
+
+void PrimorialScreen::getRemainders(
+                        const Integer& in,
+                        const Int32 first,
+                        Int64* remainders ) const
+{
+const Int64 mask = Integer::Int24BitMask;
+
+// The remainders are kept shifted by
+// blockShift, like the divisor is.
+for( Int32 lane = 0; lane < blockLanes; lane++ )
+  remainders[lane] = 0;
+
+for( Int32 count = in.getIndex(); count >= 0;
+                                       count-- )
+  {
+  const Int64 digit = in.getD( count );
+  for( Int32 lane = 0; lane < blockLanes; lane++ )
+    {
+    const Int32 which = first + lane;
+    const Int32 shiftBy = blockShift[which];
+    const Int64 norm = blockNorm[which];
+    const Int64 d1 = norm >> 24;
+    const Int64 d0 = norm & mask;
+
+    // The new number is the shifted
+    // remainder times B plus the shifted
+    // digit, which is three digits.
+    // The last block can be small enough
+    // that it is shifted by more than 24.
+    const Int64 rem = remainders[lane];
+    Int64 u2 = rem >> 24;
+    Int64 u1 = rem & mask;
+    Int64 u0 = 0;
+    if( shiftBy <= 24 )
+      {
+      const Int64 shifted = digit << shiftBy;
+      u1 |= shifted >> 24;
+      u0 = shifted & mask;
+      }
+    else
+      {
+      const Int64 shifted = digit <<
+                               (shiftBy - 24);
+      u2 |= shifted >> 24;
+      u1 |= shifted & mask;
+      }
+
+    Int64 q = (blockRecip[which] * u2) +
+                                ((u2 << 24) | u1);
+    const Int64 q0 = q & mask;
+    Int64 q1 = (q >> 24) & mask;
+
+    const Int64 r1 = (u1 - (q1 * d1)) & mask;
+    Int64 r = ((r1 << 24) | u0) - (d0 * q1) -
+                                           norm;
+    r &= Int48BitMask;
+    q1 = (q1 + 1) & mask;
+    if( (r >> 24) >= q0 )
+      {
+      q1 = (q1 - 1) & mask;
+      r = (r + norm) & Int48BitMask;
+      }
+
+    if( r >= norm )
+      {
+      // q1++ if the quotient was wanted.
+      r -= norm;
+      }
+
+    remainders[lane] = r;
+    }
+  }
+
+for( Int32 lane = 0; lane < blockLanes; lane++ )
+  remainders[lane] >>= blockShift[first + lane];
+
+}
+
+
+
+Int32 PrimorialScreen::isDivisibleBySmallPrime(
+                    const Integer& toTest ) const
+{
+if( blockCount == 0 )
+  throw "PrimorialScreen is not set up.";
+
+if( (toTest.getD( 0 ) & 1) == 0 )
+  return 2; // It's divisible by 2.
+
+Int64 remainders[blockLanes];
+for( Int32 first = 0; first < blockCount;
+                             first += blockLanes )
+  {
+  getRemainders( toTest, first, remainders );
+
+  Int32 howMany = blockCount - first;
+  if( howMany > blockLanes )
+    howMany = blockLanes;
+
+  for( Int32 lane = 0; lane < howMany; lane++ )
+    {
+    const Int32 which = first + lane;
+    const Int64 gcd = gcd64( remainders[lane],
+                             blockProd[which] );
+    if( gcd == 1 )
+      continue;
+
+    // Some prime in this block divides it.
+    // The gcd is a product of those primes,
+    // so the smallest one that divides the
+    // gcd is the answer.
+    for( Int32 count = blockStart[which];
+               count < blockEnd[which]; count++ )
+      {
+      if( (gcd % primes[count]) == 0 )
+        return Casting::i64ToI32(
+                               primes[count] );
+
+      }
+
+    throw "PrimorialScreen gcd has no prime.";
+    }
+  }
+
+// No small primes divide it.
+return 0;
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
@@ -0,0 +1,119 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// This does the same thing as
+// IntegerMath.isDivisibleBySmallPrime(), but
+// the primes from SPrimes are multiplied
+// together into blocks first.  Each block is
+// a product of consecutive primes that fits
+// in 48 bits.  It gets the remainder of the
+// number for each block in one pass through
+// the digits, then it gets the gcd of that
+// remainder and the block.  Only if the gcd
+// is not 1 does it look at the primes in
+// that block.
+
+// A block could be made much bigger than
+// 48 bits, but then the gcd is a big number
+// gcd, and that costs more than it saves.
+
+// The remainders use the 3 by 2 division from
+// Niels Moller and Torbjorn Granlund,
+// "Improved division by invariant integers",
+// with 24 bit digits.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "../CryptoBase/SPrimes.h"
+
+
+
+class PrimorialScreen
+  {
+  private:
+  bool testForCopy = false;
+
+  // How many blocks are done in one pass
+  // through the digits.
+  static const Int32 blockLanes = 8;
+  static const Int64 Int48BitMask =
+                             0xFFFFFFFFFFFFLL;
+
+  Int32 blockCount = 0;
+  Int32 blockArraySize = 0;
+
+  // The product of the primes in the block.
+  Int64* blockProd = nullptr;
+
+  // The product shifted so the top bit of
+  // 48 bits is set.
+  Int64* blockNorm = nullptr;
+
+  // ((B^3 - 1) / blockNorm) - B
+  Int64* blockRecip = nullptr;
+  Int32* blockShift = nullptr;
+
+  // The index in SPrimes of the first prime
+  // in the block, and one past the last.
+  Int32* blockStart = nullptr;
+  Int32* blockEnd = nullptr;
+
+  // The primes copied from SPrimes.
+  Int64* primes = nullptr;
+
+  static Int64 makeRecip( const Int64 norm );
+  static Int64 gcd64( Int64 x, const Int64 y );
+  void freeAll( void );
+
+  void getRemainders( const Integer& in,
+                      const Int32 first,
+                      Int64* remainders ) const;
+
+  public:
+  PrimorialScreen( void )
+    {
+    }
+
+  PrimorialScreen( const PrimorialScreen& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "PrimorialScreen copy constructor.";
+    }
+
+  ~PrimorialScreen( void )
+    {
+    freeAll();
+    }
+
+  inline bool isSetUp( void ) const
+    {
+    return blockCount > 0;
+    }
+
+  inline Int32 getBlockCount( void ) const
+    {
+    return blockCount;
+    }
+
+  void setup( const SPrimes& sPrimes );
+
+  // Returns the smallest prime from SPrimes
+  // that divides toTest, or zero if none do.
+  Int32 isDivisibleBySmallPrime(
+                   const Integer& toTest ) const;
+
+  };
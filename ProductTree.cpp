@@ -0,0 +1,147 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "ProductTree.h"
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+void ProductTree::freeAll( void )
+{
+for( Int32 count = 0; count < levelCount; count++ )
+  delete[] levels[count];
+
+delete[] levels;
+delete[] levelSizes;
+
+levels = nullptr;
+levelSizes = nullptr;
+levelCount = 0;
+}
+
+
+
+void ProductTree::build( const Integer* leaves,
+                         const Int32 howMany )
+{
+freeAll();
+
+if( howMany < 1 )
+  throw "ProductTree.build() no leaves.";
+
+Int32 size = howMany;
+Int32 howManyLevels = 1;
+while( size > 1 )
+  {
+  size = (size + 1) / 2;
+  howManyLevels++;
+  }
+
+levels = new HeapInt*[howManyLevels];
+levelSizes = new Int32[howManyLevels];
+
+levels[0] = new HeapInt[howMany];
+levelSizes[0] = howMany;
+levelCount = 1;
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  if( leaves[count].isZero())
+    throw "ProductTree.build() zero leaf.";
+
+  levels[0][count].copyFromInteger(
+                                 leaves[count] );
+  }
+
+for( Int32 level = 1; level < howManyLevels;
+                                      level++ )
+  {
+  const HeapInt* below = levels[level - 1];
+  const Int32 belowSize = levelSizes[level - 1];
+  size = (belowSize + 1) / 2;
+  HeapInt* nodes = new HeapInt[size];
+  for( Int32 count = 0; count < size; count++ )
+    {
+    const Int32 left = count * 2;
+    if( (left + 1) < belowSize )
+      HeapInt::multiply( below[left],
+                         below[left + 1],
+                         nodes[count] );
+    else
+      nodes[count].copy( below[left] );
+
+    }
+
+  levels[level] = nodes;
+  levelSizes[level] = size;
+  levelCount++;
+  }
+}
+
+
+
+const HeapInt& ProductTree::getTop( void ) const
+{
+if( levelCount == 0 )
+  throw "ProductTree.getTop() not built.";
+
+return levels[levelCount - 1][0];
+}
+
+
+
+void ProductTree::remainderTree(
+                       const HeapInt& x,
+                       const bool squared,
+                       HeapInt* results ) const
+{
+if( levelCount == 0 )
+  throw "ProductTree.remainderTree() not built.";
+
+HeapInt square;
+HeapInt* above = nullptr;
+for( Int32 level = levelCount - 1; level >= 0;
+                                      level-- )
+  {
+  const HeapInt* nodes = levels[level];
+  const Int32 size = levelSizes[level];
+  HeapInt* current = results;
+  if( level > 0 )
+    current = new HeapInt[size];
+
+  for( Int32 count = 0; count < size; count++ )
+    {
+    const HeapInt& fromAbove = (above == nullptr) ?
+                         x : above[count / 2];
+    if( squared )
+      {
+      HeapInt::multiply( nodes[count],
+                         nodes[count], square );
+      HeapInt::remainder( fromAbove, square,
+                          current[count] );
+      }
+    else
+      {
+      HeapInt::remainder( fromAbove,
+                          nodes[count],
+                          current[count] );
+      }
+    }
+
+  delete[] above;
+  above = current;
+  }
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
@@ -0,0 +1,91 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// A product tree has the numbers as the
+// leaves, and each node above that is the
+// product of its two children, so the top
+// is the product of all of them.  If a level
+// has an odd count the last one goes up as
+// it is.
+
+// The remainder tree goes back down.  It
+// takes x mod the top, and then each node
+// gets its parent's remainder mod that node.
+// So every leaf gets x mod that leaf, with
+// most of the work done on numbers that get
+// smaller as it goes down.  See Daniel
+// Bernstein, "How to find smooth parts of
+// integers" (2004), and "Fast multiplication
+// and its applications" (2008).
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "HeapInt.h"
+
+
+
+class ProductTree
+  {
+  private:
+  bool testForCopy = false;
+
+  // levels[0] is the leaves.
+  HeapInt** levels = nullptr;
+  Int32* levelSizes = nullptr;
+  Int32 levelCount = 0;
+
+  void freeAll( void );
+
+  public:
+  ProductTree( void )
+    {
+    }
+
+  ProductTree( const ProductTree& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "ProductTree copy constructor.";
+    }
+
+  ~ProductTree( void )
+    {
+    freeAll();
+    }
+
+  void build( const Integer* leaves,
+              const Int32 howMany );
+
+  inline Int32 getLeafCount( void ) const
+    {
+    if( levelCount == 0 )
+      return 0;
+
+    return levelSizes[0];
+    }
+
+  const HeapInt& getTop( void ) const;
+
+  // Each of the results gets x mod that leaf.
+  // If squared is true it is x mod the leaf
+  // squared, and every node is squared on
+  // the way down.  results has to have
+  // getLeafCount() of them.
+  void remainderTree( const HeapInt& x,
+                      const bool squared,
+                      HeapInt* results ) const;
+
+  };
@@ -0,0 +1,87 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "Recip24.h"
+#include "Division.h"
+
+
+
+void Recip24::setDivisor( const Int64 setTo )
+{
+if( (setTo <= 0) || ((setTo >> 24) != 0) )
+  throw "Recip24.setDivisor() range.";
+
+divisor = setTo;
+shiftBy = Division::findShiftBy( divisor );
+shiftBack = 24 - shiftBy;
+normDivisor = divisor << shiftBy;
+
+// This is the one real division.
+const Int64 base2 = 0xFFFFFFFFFFFFLL;
+recip = (base2 / normDivisor) -
+                     (Integer::Int24BitMask + 1);
+}
+
+
+
+Int64 Recip24::getMod( const Integer& in ) const
+{
+if( divisor == 0 )
+  throw "Recip24.getMod() divisor not set.";
+
+Int64 remShifted = 0;
+for( Int32 count = in.getIndex(); count >= 0;
+                                       count-- )
+  nextDigit( in.getD( count ), remShifted );
+
+return unShift( remShifted );
+}
+
+
+
+// Like Division.shortDivideRem().
+// The quotient can be the same object as
+// toDivide.  The quotient gets the sign of
+// toDivide (unless it is zero) and the
+// remainder is from the
+// absolute value, the same as
+// shortDivideRem() does it.
+
+Int64 Recip24::divide( const Integer& toDivide,
+                       Integer& quotient ) const
+{
+if( divisor == 0 )
+  throw "Recip24.divide() divisor not set.";
+
+const bool isNeg = toDivide.getNegative();
+const Int32 max = toDivide.getIndex();
+quotient.setIndex( max );
+
+Int64 remShifted = 0;
+for( Int32 count = max; count >= 0; count-- )
+  {
+  const Int64 digit = toDivide.getD( count );
+  quotient.setD( count, nextDigit( digit,
+                                 remShifted ));
+  }
+
+Int32 qIndex = max;
+while( (qIndex > 0) &&
+       (quotient.getD( qIndex ) == 0) )
+  qIndex--;
+
+quotient.setIndex( qIndex );
+quotient.setNegative( false );
+if( isNeg && !quotient.isZero())
+  quotient.setNegative( true );
+
+return unShift( remShifted );
+}
@@ -0,0 +1,124 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// Division by a 24 bit number using a
+// precomputed reciprocal instead of the
+// hardware divide instruction.
+
+// Niels Moller and Torbjorn Granlund,
+// "Improved division by invariant integers",
+// IEEE Transactions on Computers 60 (2011).
+// This is their 2 by 1 division, with
+// 24 bit digits, so all of the products fit
+// in an Int64.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+
+
+
+class Recip24
+  {
+  private:
+  bool testForCopy = false;
+  Int64 divisor = 0;
+
+  // The divisor shifted left so the 0x800000
+  // bit is set.
+  Int64 normDivisor = 0;
+
+  // ((B^2 - 1) / normDivisor) - B
+  Int64 recip = 0;
+  Int32 shiftBy = 0;
+  Int32 shiftBack = 24;
+
+  // u1 has to be less than normDivisor.
+  // This divides (u1 * B) + u0 by normDivisor.
+  inline Int64 divideTwo( const Int64 u1,
+                          const Int64 u0,
+                          Int64& remainder ) const
+    {
+    Int64 q = (recip * u1) + (u1 << 24) + u0;
+    const Int64 qLow = q & Integer::Int24BitMask;
+    q = ((q >> 24) + 1) & Integer::Int24BitMask;
+    Int64 r = (u0 - (q * normDivisor)) &
+                         Integer::Int24BitMask;
+    if( r > qLow )
+      {
+      q = (q - 1) & Integer::Int24BitMask;
+      r = (r + normDivisor) &
+                         Integer::Int24BitMask;
+      }
+
+    if( r >= normDivisor )
+      {
+      q++;
+      r -= normDivisor;
+      }
+
+    remainder = r;
+    return q;
+    }
+
+  public:
+  Recip24( void )
+    {
+    }
+
+  Recip24( const Recip24& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "Recip24 copy constructor.";
+    }
+
+  ~Recip24( void )
+    {
+    }
+
+  inline Int64 getDivisor( void ) const
+    {
+    return divisor;
+    }
+
+  void setDivisor( const Int64 setTo );
+
+  // For when the remainder so far is carried
+  // from one digit to the next.  The
+  // remainder stays shifted by shiftBy, and
+  // this returns the next quotient digit.
+  inline Int64 nextDigit( const Int64 digit,
+                          Int64& remShifted ) const
+    {
+    const Int64 u1 = remShifted |
+                      (digit >> shiftBack);
+    const Int64 u0 = (digit << shiftBy) &
+                         Integer::Int24BitMask;
+    return divideTwo( u1, u0, remShifted );
+    }
+
+  inline Int64 unShift( const Int64 remShifted )
+                                           const
+    {
+    return remShifted >> shiftBy;
+    }
+
+  Int64 getMod( const Integer& in ) const;
+
+  Int64 divide( const Integer& toDivide,
+                Integer& quotient ) const;
+
+  };
@@ -0,0 +1,319 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "RsaCrt.h"
+#include "Division.h"
+#include "LehmerGcd.h"
+
+#include <thread>
+
+
+#include "../CppMem/MemoryWarnTop.h"
+
+
+
+void RsaCrt::freeAll( void )
+{
+delete[] primes;
+delete[] exponents;
+delete[] coefs;
+delete[] parts;
+delete[] mods;
+delete[] intMaths;
+
+primes = nullptr;
+exponents = nullptr;
+coefs = nullptr;
+parts = nullptr;
+mods = nullptr;
+intMaths = nullptr;
+primeCount = 0;
+}
+
+
+
+void RsaCrt::setPrimeCount( const Int32 howMany )
+{
+if( (howMany < 2) || (howMany > MaxPrimes) )
+  throw "RsaCrt prime count range.";
+
+freeAll();
+
+primes = new Integer[howMany];
+exponents = new Integer[howMany];
+coefs = new Integer[howMany];
+parts = new Integer[howMany];
+mods = new Mod[howMany];
+intMaths = new IntegerMath[howMany];
+primeCount = howMany;
+}
+
+
+
+// coefs[count] is the inverse of the product
+// of all of the primes before it.
+
+void RsaCrt::setCoefs( IntegerMath& intMath )
+{
+Integer prod;
+Integer reduced;
+Integer gcd;
+prod.copy( primes[0] );
+coefs[0].setToOne();
+for( Int32 count = 1; count < primeCount;
+                                      count++ )
+  {
+  Division::remainderOnly( prod, primes[count],
+                           reduced, intMath );
+  if( !LehmerGcd::multInverse( reduced,
+                               primes[count],
+                               coefs[count],
+                               gcd, intMath ))
+    throw "RsaCrt primes are not coprime.";
+
+  intMath.multiply( prod, primes[count] );
+  }
+}
+
+
+
+void RsaCrt::setKey( const Integer& p,
+                     const Integer& q,
+                     const Integer& dP,
+                     const Integer& dQ,
+                     const Integer& qInv,
+                     IntegerMath& intMath )
+{
+setPrimeCount( 2 );
+
+primes[0].copy( q );
+primes[1].copy( p );
+exponents[0].copy( dQ );
+exponents[1].copy( dP );
+coefs[0].setToOne();
+coefs[1].copy( qInv );
+
+for( Int32 count = 0; count < 2; count++ )
+  {
+  mods[count].verifyInBaseRange(
+                       exponents[count],
+                       primes[count],
+                       "RsaCrt.setKey() exponent" );
+  }
+
+mods[1].verifyInBaseRange( qInv, p,
+                         "RsaCrt.setKey() qInv" );
+
+// A wrong qInv would give wrong answers
+// that look fine, so check it once here.
+Integer check;
+check.copy( q );
+Division::remainderOnly( check, p, check,
+                                    intMath );
+mods[1].multiply( check, qInv, p, intMath );
+if( !check.isOne())
+  throw "RsaCrt qInv is wrong.";
+
+}
+
+
+
+void RsaCrt::setMultiPrimeKey(
+                       const Integer* setPrimes,
+                       const Int32 howMany,
+                       const Integer& privateExp,
+                       IntegerMath& intMath )
+{
+setPrimeCount( howMany );
+
+primes[0].copy( setPrimes[1] );
+primes[1].copy( setPrimes[0] );
+for( Int32 count = 2; count < howMany; count++ )
+  primes[count].copy( setPrimes[count] );
+
+Integer minusOne;
+for( Int32 count = 0; count < howMany; count++ )
+  {
+  mods[count].verifyMoreThanZero(
+                                primes[count] );
+  minusOne.copy( primes[count] );
+  minusOne.decrement();
+  if( minusOne.isZero() || minusOne.isOne())
+    throw "RsaCrt prime is too small.";
+
+  Division::remainderOnly( privateExp, minusOne,
+                           exponents[count],
+                           intMath );
+  }
+
+setCoefs( intMath );
+}
+
+
+
+void RsaCrt::makePart( const Integer& cipher,
+                       const Int32 which )
+{
+const Integer& prime = primes[which];
+IntegerMath& partMath = intMaths[which];
+Integer& part = parts[which];
+
+Division::remainderOnly( cipher, prime, part,
+                                   partMath );
+mods[which].toPower( part, exponents[which],
+                     prime, partMath );
+}
+
+
+
+void RsaCrt::worker( const Integer* cipher,
+                     const Int32 first,
+                     const Int32 step,
+                     const char** error )
+{
+try
+{
+for( Int32 count = first; count < primeCount;
+                                 count += step )
+  makePart( *cipher, count );
+
+}
+catch( const char* in )
+  {
+  *error = in;
+  }
+catch( ... )
+  {
+  *error = "RsaCrt worker exception.";
+  }
+}
+
+
+
+void RsaCrt::privateOp( Integer& result,
+                        const Integer& cipher,
+                        const Int32 threadCount,
+                        IntegerMath& intMath )
+{
+if( primeCount == 0 )
+  throw "RsaCrt key is not set.";
+
+if( threadCount < 1 )
+  throw "RsaCrt threadCount range.";
+
+if( cipher.getNegative())
+  throw "RsaCrt cipher is negative.";
+
+Int32 howManyThreads = threadCount;
+if( howManyThreads > primeCount )
+  howManyThreads = primeCount;
+
+if( howManyThreads == 1 )
+  {
+  for( Int32 count = 0; count < primeCount;
+                                      count++ )
+    makePart( cipher, count );
+
+  }
+else
+  {
+  // This thread does the first share
+  // itself.
+  std::thread* threads = new std::thread[
+                                howManyThreads];
+  const char* errors[MaxPrimes];
+  for( Int32 count = 0; count < howManyThreads;
+                                      count++ )
+    errors[count] = nullptr;
+
+  try
+  {
+  for( Int32 count = 1; count < howManyThreads;
+                                      count++ )
+    threads[count] = std::thread(
+                      &RsaCrt::worker, this,
+                      &cipher, count,
+                      howManyThreads,
+                      &errors[count] );
+
+  }
+  catch( ... )
+    {
+    // The threads that did start write to
+    // errors and to parts, so they have to
+    // finish before this returns.
+    for( Int32 count = 1; count < howManyThreads;
+                                      count++ )
+      {
+      if( threads[count].joinable())
+        threads[count].join();
+
+      }
+
+    delete[] threads;
+    throw;
+    }
+
+  worker( &cipher, 0, howManyThreads,
+                               &errors[0] );
+
+  for( Int32 count = 1; count < howManyThreads;
+                                      count++ )
+    threads[count].join();
+
+  delete[] threads;
+
+  for( Int32 count = 0; count < howManyThreads;
+                                      count++ )
+    {
+    if( errors[count] != nullptr )
+      throw errors[count];
+
+    }
+  }
+
+// Garner's formula.  After the step for
+// primes[count], result is right mod the
+// product of primes[0] through
+// primes[count], and it is less than that
+// product.
+Integer prod;
+Integer reduced;
+Integer h;
+result.copy( parts[0] );
+prod.copy( primes[0] );
+for( Int32 count = 1; count < primeCount;
+                                      count++ )
+  {
+  const Integer& prime = primes[count];
+  Mod& mod = mods[count];
+
+  // h = (part - result) * coef mod prime.
+  Division::remainderOnly( result, prime,
+                           reduced, intMath );
+  h.copy( parts[count] );
+  mod.subtract( h, reduced, prime, intMath );
+  mod.multiply( h, coefs[count], prime,
+                                    intMath );
+
+  // result += prod * h.
+  intMath.multiply( h, prod );
+  result.add( h );
+
+  if( (count + 1) < primeCount )
+    intMath.multiply( prod, prime );
+
+  }
+}
+
+
+
+#include "../CppMem/MemoryWarnBottom.h"
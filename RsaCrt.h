@@ -0,0 +1,124 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// RSA private key operations with the Chinese
+// Remainder Theorem.  Instead of one power
+// mod n with the full size d, it does a power
+// mod each prime with d mod (prime - 1).
+// For two primes those are half the size,
+// so each one costs about an eighth as much,
+// and then Garner's formula puts the parts
+// back together.  Each prime has its own Mod
+// so its NumbSys keeps the base array for
+// that prime from one call to the next,
+// instead of setting it up again each time
+// it switches primes.  The parts don't
+// depend on each other, so they can be done
+// on separate threads.
+
+// More than two primes is multi-prime RSA
+// from RFC 8017.  The primes are kept in the
+// order that Garner's formula uses them in,
+// which is q, p, and then r_3 and on, and
+// coefs[count] is the inverse of the product
+// of the primes before it, mod that prime.
+// For two primes coefs[1] is qInv.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "Mod.h"
+
+
+
+class RsaCrt
+  {
+  private:
+  bool testForCopy = false;
+  static const Int32 MaxPrimes = 16;
+  Int32 primeCount = 0;
+  Integer* primes = nullptr;
+  Integer* exponents = nullptr;
+  Integer* coefs = nullptr;
+
+  // The power mod each prime.
+  Integer* parts = nullptr;
+
+  // Each prime has its own, so that each
+  // part can be done on its own thread.
+  Mod* mods = nullptr;
+  IntegerMath* intMaths = nullptr;
+
+  void freeAll( void );
+  void setPrimeCount( const Int32 howMany );
+  void setCoefs( IntegerMath& intMath );
+  void makePart( const Integer& cipher,
+                 const Int32 which );
+  void worker( const Integer* cipher,
+               const Int32 first,
+               const Int32 step,
+               const char** error );
+
+  public:
+  RsaCrt( void )
+    {
+    }
+
+  RsaCrt( const RsaCrt& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "RsaCrt copy constructor.";
+    }
+
+  ~RsaCrt( void )
+    {
+    freeAll();
+    }
+
+  // The usual two prime key, with
+  // dP = d mod (p - 1), dQ = d mod (q - 1)
+  // and qInv = q^-1 mod p.
+  void setKey( const Integer& p,
+               const Integer& q,
+               const Integer& dP,
+               const Integer& dQ,
+               const Integer& qInv,
+               IntegerMath& intMath );
+
+  // setPrimes[0] is p and setPrimes[1] is q,
+  // like in RFC 8017.  This works out the
+  // exponents and coefficients from d.
+  void setMultiPrimeKey( const Integer* setPrimes,
+                         const Int32 howMany,
+                         const Integer& privateExp,
+                         IntegerMath& intMath );
+
+  inline Int32 getPrimeCount( void ) const
+    {
+    return primeCount;
+    }
+
+  // result = cipher^d mod n.  cipher has to
+  // be less than n.  With threadCount more
+  // than 1 the parts are done on that many
+  // threads, up to one for each prime.
+  void privateOp( Integer& result,
+                  const Integer& cipher,
+                  const Int32 threadCount,
+                  IntegerMath& intMath );
+
+  };
@@ -0,0 +1,247 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#include "SafePrime.h"
+#include "Division.h"
+
+
+
+bool SafePrime::isFermat2( const Integer& n,
+                           Mod& mod,
+                           IntegerMath& intMath )
+{
+fermatTests++;
+nMinus1.copy( n );
+nMinus1.decrement();
+fermat.setFromLong48( 2 );
+mod.toPower( fermat, nMinus1, n, intMath );
+return fermat.isOne();
+}
+
+
+
+bool SafePrime::isPrime( const Integer& n,
+                         const SPrimes& sPrimes,
+                         IntegerMath& intMath )
+{
+if( intMath.isDivisibleBySmallPrime( n, sPrimes )
+                                         != 0 )
+  return false;
+
+fullTests++;
+return bpsw.isProbablePrime( n, sPrimes,
+                             intMath );
+}
+
+
+
+void SafePrime::makeRandom( Integer& result,
+                            const Int32 setToIndex )
+{
+for( Int32 count = 0; count < 100; count++ )
+  {
+  if( result.makeRandomOdd( setToIndex ))
+    return;
+
+  }
+
+throw "SafePrime.makeRandom() failed.";
+}
+
+
+
+void SafePrime::makeSafePrime( Integer& p,
+                          Integer& q,
+                          const Int32 qIndex,
+                          const SPrimes& sPrimes,
+                          IntegerMath& intMath )
+{
+if( qIndex < 2 )
+  throw "SafePrime.makeSafePrime() qIndex.";
+
+// The same Mod as the Baillie-PSW test on q,
+// so the tables for q get made once.
+Mod& modQ = bpsw.getMillerRabin().getMod();
+
+Integer start;
+search.setSieveSafe( true );
+
+for( Int32 tries = 0; tries < 1000; tries++ )
+  {
+  makeRandom( start, qIndex );
+  search.setStart( start, 2, sPrimes );
+
+  // A safe prime near a 1024 bit number
+  // is usually within a few hundred
+  // thousand.  Past this, start over.
+  while( search.getOffset() < 0x100000 )
+    {
+    search.nextCandidate( q );
+    if( q.getIndex() != qIndex )
+      break;
+
+    candidatesSieved++;
+
+    // p = 2q + 1
+    p.copy( q );
+    p.shiftLeft( 1 );
+    p.increment();
+
+    if( !isFermat2( q, modQ, intMath ))
+      continue;
+
+    if( !isFermat2( p, modP, intMath ))
+      continue;
+
+    fullTests++;
+    if( bpsw.isProbablePrime( q, sPrimes,
+                              intMath ))
+      return;
+
+    }
+  }
+
+throw "SafePrime.makeSafePrime() failed.";
+}
+
+
+
+void SafePrime::makePrime( Integer& result,
+                           const Int32 setToIndex,
+                           const SPrimes& sPrimes,
+                           IntegerMath& intMath )
+{
+if( setToIndex < 2 )
+  throw "SafePrime.makePrime() setToIndex.";
+
+Integer start;
+search.setSieveSafe( false );
+
+for( Int32 tries = 0; tries < 1000; tries++ )
+  {
+  makeRandom( start, setToIndex );
+  search.setStart( start, 2, sPrimes );
+  while( search.getOffset() < 0x10000 )
+    {
+    search.nextCandidate( result );
+    if( result.getIndex() != setToIndex )
+      break;
+
+    candidatesSieved++;
+    fullTests++;
+    if( bpsw.isProbablePrime( result, sPrimes,
+                              intMath ))
+      return;
+
+    }
+  }
+
+throw "SafePrime.makePrime() failed.";
+}
+
+
+
+void SafePrime::makeStrongPrime( Integer& result,
+                          const Int32 setToIndex,
+                          const SPrimes& sPrimes,
+                          IntegerMath& intMath )
+{
+if( setToIndex < 8 )
+  throw "SafePrime.makeStrongPrime() setToIndex.";
+
+// s and t are a little less than half the
+// size of p.  Then 2rs is at least about 30
+// bits shorter than p, so there are a lot
+// of p values with the right size.
+const Int32 sIndex = (setToIndex / 2) - 1;
+const Int32 tIndex = sIndex - 1;
+
+Integer s;
+Integer t;
+makePrime( s, sIndex, sPrimes, intMath );
+makePrime( t, tIndex, sPrimes, intMath );
+
+// r = 2it + 1 for the first i that makes
+// it prime.
+Integer twoT;
+twoT.copy( t );
+twoT.shiftLeft( 1 );
+
+Integer r;
+r.copy( twoT );
+r.increment();
+for( Int32 count = 0; ; count++ )
+  {
+  if( count > 100000 )
+    throw "SafePrime.makeStrongPrime() no r.";
+
+  if( isPrime( r, sPrimes, intMath ))
+    break;
+
+  r.add( twoT );
+  }
+
+// p0 = 2(s^(r-2) mod r)s - 1.
+// s^(r-2) is the inverse of s mod r, so
+// p0 = 1 mod r and p0 = -1 mod s.
+Integer rMinus2;
+rMinus2.copy( r );
+rMinus2.decrement();
+rMinus2.decrement();
+
+Integer p0;
+p0.copy( s );
+modP.toPower( p0, rMinus2, r, intMath );
+intMath.multiply( p0, s );
+p0.shiftLeft( 1 );
+p0.decrement();
+
+// p = p0 + 2jrs, which keeps both of those.
+Integer twoRS;
+twoRS.copy( r );
+intMath.multiply( twoRS, s );
+twoRS.shiftLeft( 1 );
+
+// j starts at a random number that makes p
+// at least start, which has the top bit
+// set.  If p gets past the top digit before
+// a prime turns up it starts over.  p0 is
+// less than 2rs.
+Integer start;
+Integer remainder;
+for( Int32 tries = 0; tries < 1000; tries++ )
+  {
+  makeRandom( start, setToIndex );
+  start.setD( setToIndex,
+              start.getD( setToIndex ) | 0x800000 );
+
+  // The first number at or above start that
+  // is p0 mod 2rs.
+  Division::remainderOnly( start, twoRS,
+                           remainder, intMath );
+  result.copy( start );
+  result.add( p0 );
+  result.subtract( remainder );
+  if( result.paramIsGreater( start ))
+    result.add( twoRS );
+
+  while( result.getIndex() == setToIndex )
+    {
+    candidatesSieved++;
+    if( isPrime( result, sPrimes, intMath ))
+      return;
+
+    result.add( twoRS );
+    }
+  }
+
+throw "SafePrime.makeStrongPrime() no p.";
+}
@@ -0,0 +1,125 @@
+// Copyright Eric Chauvin 2021 - 2023.
+
+
+
+// This is licensed under the GNU General
+// Public License (GPL).  It is the
+// same license that Linux has.
+// https://www.gnu.org/licenses/gpl-3.0.html
+
+
+
+#pragma once
+
+
+// Safe primes p = 2q + 1 where q is prime,
+// and strong primes from Gordon's algorithm.
+
+// For safe primes the sieve takes out q when
+// a small prime divides q or 2q + 1, using
+// the same residues for both.  Then there is
+// a base 2 Fermat test on q and on p before
+// the full test.  Most candidates fail one of
+// those cheap tests.  The full Baillie-PSW
+// test is only done on q.  If q is prime and
+// 2^(p-1) = 1 mod p, then p is prime by
+// Pocklington's theorem, since q is more than
+// the square root of p and 2^2 - 1 = 3 has
+// no factor in common with p.
+
+// John Gordon, "Strong primes are easy to
+// find", Eurocrypt 1984.  A strong prime p
+// has a big prime factor r of p - 1, a big
+// prime factor s of p + 1, and a big prime
+// factor t of r - 1.
+
+
+#include "../CppBase/BasicTypes.h"
+#include "Integer.h"
+#include "IntegerMath.h"
+#include "Mod.h"
+#include "BailliePSW.h"
+#include "PrimeSearch.h"
+#include "../CryptoBase/SPrimes.h"
+
+
+
+class SafePrime
+  {
+  private:
+  bool testForCopy = false;
+  BailliePSW bpsw;
+  Mod modP;
+  PrimeSearch search;
+  Integer nMinus1;
+  Integer fermat;
+
+  Int64 candidatesSieved = 0;
+  Int64 fermatTests = 0;
+  Int64 fullTests = 0;
+
+  bool isFermat2( const Integer& n,
+                  Mod& mod,
+                  IntegerMath& intMath );
+
+  bool isPrime( const Integer& n,
+                const SPrimes& sPrimes,
+                IntegerMath& intMath );
+
+  void makeRandom( Integer& result,
+                   const Int32 setToIndex );
+
+  public:
+  SafePrime( void )
+    {
+    }
+
+  SafePrime( const SafePrime& in )
+    {
+    if( in.testForCopy )
+      return;
+
+    throw "SafePrime copy constructor.";
+    }
+
+  ~SafePrime( void )
+    {
+    }
+
+  // q gets qIndex + 1 digits and p = 2q + 1.
+  void makeSafePrime( Integer& p,
+                      Integer& q,
+                      const Int32 qIndex,
+                      const SPrimes& sPrimes,
+                      IntegerMath& intMath );
+
+  // A random probable prime with
+  // setToIndex + 1 digits.
+  void makePrime( Integer& result,
+                  const Int32 setToIndex,
+                  const SPrimes& sPrimes,
+                  IntegerMath& intMath );
+
+  // The result has setToIndex + 1 digits
+  // and the top bit set, like PrimeGenerator.
+  void makeStrongPrime( Integer& result,
+                        const Int32 setToIndex,
+                        const SPrimes& sPrimes,
+                        IntegerMath& intMath );
+
+  inline Int64 getCandidatesSieved( void ) const
+    {
+    return candidatesSieved;
+    }
+
+  inline Int64 getFermatTests( void ) const
+    {
+    return fermatTests;
+    }
+
+  inline Int64 getFullTests( void ) const
+    {
+    return fullTests;
+    }
+
+  };